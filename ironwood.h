@@ -0,0 +1,125 @@
+// ============================================================
+//  Ironwood v3.2 — embedding API
+//  Build ironwood_vr1.cpp into the host with -DIRONWOOD_NO_MAIN:
+//    g++ -std=c++17 -O2 -pthread -DIRONWOOD_NO_MAIN -c ironwood_vr1.cpp
+//
+//    ironwood::Engine engine;
+//    engine.define("log",[](const std::vector<ironwood::Value>& a){ ...; return ironwood::Value(); });
+//    auto program=ironwood::Engine::compile("say \"hi \" + name\nreturn 42");
+//    ironwood::Value r=engine.execute(program,{{"name","web"}});   // r holds 42
+//
+//  An Engine is one interpreter kept warm between scripts: its
+//  value pool, call frames and builtins are made once, and every
+//  execute starts from a clean global scope. A compiled Program
+//  is read-only and can run on any number of engines at once.
+//  One Engine runs one script at a time; EnginePool hands out
+//  engines to threads.
+// ============================================================
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace ironwood {
+
+// A value passed between the host and a script. Lists and dicts are copied across;
+// functions don't cross (they arrive as null).
+struct Value {
+    using List=std::vector<Value>;
+    using Dict=std::vector<std::pair<std::string,Value>>;  // sorted by key when it comes from a script
+    std::variant<std::nullptr_t,bool,double,std::string,List,Dict> data;
+
+    Value():data(nullptr){}
+    Value(std::nullptr_t):data(nullptr){}
+    Value(bool b):data(b){}
+    Value(int n):data((double)n){}
+    Value(double d):data(d){}
+    Value(const char* s):data(std::string(s)){}
+    Value(std::string s):data(std::move(s)){}
+    Value(List l):data(std::move(l)){}
+    Value(Dict d):data(std::move(d)){}
+
+    bool isNull() const {return std::holds_alternative<std::nullptr_t>(data);}
+    template<class T> const T* as() const {return std::get_if<T>(&data);}  // null if it holds something else
+};
+
+// A syntax error from compile, or an uncaught error / exceeded limit from execute
+struct Error : std::runtime_error { using std::runtime_error::runtime_error; };
+
+// Host functions scripts can call. Throwing std::exception gives the script a catchable error.
+using NativeFunction=std::function<Value(const std::vector<Value>&)>;
+
+class Program;
+using ProgramPtr=std::shared_ptr<const Program>;
+
+// Per-engine versions of --max-depth, --max-heap, --max-steps and --timeout (0 = none)
+struct Limits {
+    size_t maxDepth=10000;
+    size_t maxHeap=0;
+    uint64_t maxSteps=0;
+    double timeout=0;
+};
+
+class Engine {
+public:
+    explicit Engine(const Limits& limits=Limits());
+    ~Engine();
+    Engine(const Engine&)=delete;
+    Engine& operator=(const Engine&)=delete;
+
+    // Parse and optimize once; the result doesn't belong to any engine
+    static ProgramPtr compile(const std::string& source);
+    // A global function every later execute sees (defining a name again replaces it)
+    void define(const std::string& name,NativeFunction fn);
+    // Where 'say' writes (std::cout until set); the stream must outlive its use here
+    void setOutput(std::ostream& out);
+    // Run with these extra globals. Returns what a top-level 'return' gave back, or null.
+    // Everything the script made is gone afterwards; host functions and limits stay.
+    // The script runs on a helper thread sized for maxDepth calls, so host functions
+    // are called from that thread.
+    Value execute(const ProgramPtr& program,const std::vector<std::pair<std::string,Value>>& globals={});
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+// A fixed set of warm engines shared by threads. acquire() waits until one is free.
+class EnginePool {
+public:
+    class Lease {
+    public:
+        Lease(Lease&& o) noexcept:pool(o.pool),engine(o.engine){o.engine=nullptr;}
+        Lease& operator=(Lease&&)=delete;
+        ~Lease(){if(engine)pool->release(engine);}
+        Engine& operator*() const {return *engine;}
+        Engine* operator->() const {return engine;}
+    private:
+        friend class EnginePool;
+        Lease(EnginePool* p,Engine* e):pool(p),engine(e){}
+        EnginePool* pool;Engine* engine;
+    };
+
+    explicit EnginePool(size_t size,const Limits& limits=Limits());
+    Lease acquire();
+    // defines the function on every engine; call it before handing engines out
+    void define(const std::string& name,const NativeFunction& fn);
+    size_t size() const {return engines.size();}
+
+private:
+    void release(Engine* e);
+    std::vector<std::unique_ptr<Engine>> engines;
+    std::vector<Engine*> idle;
+    std::mutex m;
+    std::condition_variable freed;
+};
+
+} // namespace ironwood
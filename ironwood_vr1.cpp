@@ -1,6 +1,6 @@
 // ============================================================
 //  Ironwood v3.1 — General Purpose Language
-//  Compile: g++ -std=c++17 -O2 -o ironwood ironwood_v2.cpp
+//  Compile: g++ -std=c++17 -O2 -pthread -o ironwood ironwood_v2.cpp
 //  Run:     ./ironwood program.irw [arg1 arg2 ...]
 //
 //  v2.0:  Classes, error handling, dict ops, file I/O
@@ -11,6 +11,46 @@
 //                 Returns {body, status, ok}
 //    Subprocess — run "ls -la"
 //                 Returns {output, code, ok}
+//  v3.2 New Features:
+//    Async fetch — let h = async fetch "url" [with {...}]  → pending handle
+//                  await h / await [h1, h2] / await fetch [url1, url2]
+//                  Requests overlap on one epoll event loop
+//    Keep-alive  — fetch reuses HTTP/1.1 connections per host:port and caches DNS
+//    Downloads   — fetch "url" to file "path"  → body streamed to disk
+//                  Returns {status, ok, path, bytes}
+//    Subprocess  — run ["prog", "arg"] [with {input: "..."}]  → no shell, stderr apart
+//                  Returns {output, error, code, ok}
+//                  for each line in run ... → lines streamed as they are printed
+//                  run all [cmds] [with {parallel: N}] → list of results, in order
+//    Modules     — each .irw module runs once; every 'get' of it shares one exports object
+//                  all reachable modules are parsed in parallel before the program starts
+//    AST cache   — parsed programs saved as <file>.irwc (or in $IRONWOOD_CACHE_DIR),
+//                  reused while the source is unchanged; --no-cache disables
+//    Tail calls  — 'return f(...)' reuses the caller's frame; deep recursion runs in constant stack
+//    Call depth  — frames come from a preallocated pool; past --max-depth (default 10000)
+//                  a catchable "Stack overflow" error is thrown instead of crashing
+//    Optimizer   — constant folding, dead if/while bodies dropped, literal lists prebuilt; -O0 disables
+//    Loops       — for i from a to b [by step] counts without a list; 'while i < n ... set i = i + 1'
+//                  keeps i in place; for each walks the list itself instead of a copy
+//    Sort        — sort xs [by key [descending]] [then key ...]; keys computed once per item,
+//                  big lists sorted in parallel
+//    Numbers     — sum of / min of / max of / average of list; list + list, list * n
+//    CSV         — parse csv text / csv file "p" [with {header: true, separator: ";"}] → rows;
+//                  csv of rows [with {columns: [...]}] → text; for each row in csv file "p" streams the file
+//    Cycle GC    — lists, dicts and closures that reference each other are collected; --gc-stats
+//    Value pool  — values, list buffers and dict nodes come from per-interpreter size-class slabs
+//    Heap limit  — --max-heap N[k|m|g] → catchable "Out of memory" error; memory used → bytes in use
+//    Budgets     — --max-steps N / --timeout S stop runaway scripts with the line they were on
+//    Embedding   — ironwood.h: Engine::compile once, engine.execute(program, globals) many times,
+//                  host functions via engine.define; EnginePool shares warm engines (-DIRONWOOD_NO_MAIN)
+//    Serve       — --serve <socket> [--workers N]: daemon running 'path TAB args' requests with
+//                  cached programs and modules, one warm interpreter per worker thread
+//    HTTP server — serve on port N with handler | with {handler, workers, host}; handler(req) returns
+//                  {status, body, headers} or a string; keep-alive, epoll, workers = forked processes
+//    Lexer       — tokens pulled by the parser one at a time as views of the source;
+//                  keywords found by perfect hash
+//    Check       — --check <files | dirs>: syntax, undefined names, set before let, unknown classes
+//                  and call arity reported as path:line without running anything; files checked in parallel
 // ============================================================
 
 #include <iostream>
@@ -27,7 +67,10 @@
 #include <algorithm>
 #include <unordered_set>
 #include <list>
+#include <deque>
 #include <limits>
+#include <array>
+#include <string_view>
 // networking / subprocess — cross-platform
 #ifdef _WIN32
 #  include <winsock2.h>
@@ -37,9 +80,12 @@
    typedef int ssize_t;
 #  endif
 #  define close(s) closesocket(s)
+#  include <process.h>
+#  define getpid _getpid
    // popen/pclose are available on Windows as _popen/_pclose
 #  define popen  _popen
 #  define pclose _pclose
+#  define poll   WSAPoll
    // WIFEXITED / WEXITSTATUS are not defined on Windows; pclose returns the exit code directly
 #  ifndef WIFEXITED
 #    define WIFEXITED(s)   (true)
@@ -48,12 +94,75 @@
 #else
 #  include <sys/socket.h>
 #  include <netinet/in.h>
+#  include <netinet/tcp.h>
 #  include <netdb.h>
+#  include <sys/un.h>
 #  include <unistd.h>
 #  include <sys/wait.h>
+#  include <fcntl.h>
+#  include <spawn.h>
+#  include <csignal>
+   extern char** environ;
+#  include <poll.h>
+#  include <pthread.h>
+#  include <sys/resource.h>
+#  ifdef __linux__
+#    include <sys/epoll.h>
+#    include <sys/prctl.h>
+#  endif
 #endif
 #include <cstring>
+#include <cerrno>
+#ifdef __SSE2__
+#  include <emmintrin.h>
+#endif
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0   // Windows / macOS: no per-call flag
+#endif
 #include <ctime>
+#include "ironwood.h"
+
+// v3.2: every descriptor the interpreter opens is close-on-exec, so a child started by 'run'
+// inherits only the stdin/stdout/stderr posix_spawn hands it — not the pipes of other
+// children, pooled connections or a server's sockets
+static int openSocket(int family,int type,int protocol){
+#ifdef SOCK_CLOEXEC
+    return (int)socket(family,type|SOCK_CLOEXEC,protocol);
+#else
+    int fd=(int)socket(family,type,protocol);
+#  ifndef _WIN32
+    if(fd>=0)fcntl(fd,F_SETFD,FD_CLOEXEC);
+#  endif
+    return fd;
+#endif
+}
+static int acceptSocket(int listener){
+#ifdef __linux__
+    return accept4(listener,nullptr,nullptr,SOCK_CLOEXEC);
+#else
+    int fd=(int)accept(listener,nullptr,nullptr);
+#  ifndef _WIN32
+    if(fd>=0)fcntl(fd,F_SETFD,FD_CLOEXEC);
+#  endif
+    return fd;
+#endif
+}
+#ifndef _WIN32
+static int openPipe(int fds[2]){
+#  ifdef __linux__
+    return pipe2(fds,O_CLOEXEC);
+#  else
+    if(pipe(fds)<0)return -1;
+    fcntl(fds[0],F_SETFD,FD_CLOEXEC);fcntl(fds[1],F_SETFD,FD_CLOEXEC);
+    return 0;
+#  endif
+}
+#endif
 
 // ============================================================
 //  TOKENS
@@ -81,6 +190,8 @@ enum class TT {
     TYPE_KW, THEN, SORT_KW, JSON_KW, PARSE_KW,
     // v3.1 networking + subprocess
     FETCH_KW, RUN_KW,
+    // v3.2 async fetch
+    ASYNC_KW, AWAIT_KW,
     // operators
     PLUS, MINUS, STAR, SLASH, PERCENT,
     EQ, NEQ, LT, GT, LEQ, GEQ, ASSIGN,
@@ -88,88 +199,114 @@ enum class TT {
     COMMA, DOT, COLON, NEWLINE, EOF_T
 };
 
-struct Token { TT type; std::string val; int line{1}; };
+// v3.2: 'val' views the source text (or the lexer's copy of an escaped string literal);
+// it stays valid as long as the Lexer that made the token
+struct Token { TT type; std::string_view val; int line{1}; };
 
 // ============================================================
 //  LEXER
 // ============================================================
 
+// v3.2: keywords live in a perfect hash — the seed is chosen once so that no two
+// keywords share a slot, and a lookup is one hash of the word plus one compare
+class KeywordTable {
+    static constexpr size_t SLOTS=512;
+    struct Slot { std::string_view word; TT type{TT::IDENT}; };
+    std::array<Slot,SLOTS> slots{};
+    uint32_t seed{2166136261u};
+    static uint32_t hash(std::string_view s,uint32_t h){for(unsigned char c:s)h=(h^c)*16777619u;return h;}
+public:
+    KeywordTable(std::initializer_list<std::pair<std::string_view,TT>> words){
+        for(;;seed++){
+            slots.fill({});bool clash=false;
+            for(auto& [w,t]:words){Slot& sl=slots[hash(w,seed)%SLOTS];if(!sl.word.empty()){clash=true;break;}sl={w,t};}
+            if(!clash)return;
+        }
+    }
+    TT find(std::string_view s) const {const Slot& sl=slots[hash(s,seed)%SLOTS];return sl.word==s?sl.type:TT::IDENT;}
+};
+
+// v3.2: the lexer hands out one token per next() so the Parser never holds more than
+// its lookahead; the source must outlive the Lexer
 class Lexer {
-    std::string src;
+    std::string_view src;
     size_t pos{0};
     int    line{1};
+    bool   lastNL{true};
+    std::deque<std::string> unescaped;  // string literals that had escapes (deque: views stay put)
 
-    static const std::unordered_map<std::string, TT> kw;
+    static const KeywordTable kw;
 
     char peek(int off=0) const { size_t i=pos+off; return i<src.size()?src[i]:'\0'; }
     char advance() { char c=src[pos++]; if(c=='\n')line++; return c; }
     void skipComment() { while(pos<src.size()&&src[pos]!='\n')pos++; }
 
     Token makeStr() {
-        std::string s;
+        size_t start=pos;
+        while(pos<src.size()&&src[pos]!='"'&&src[pos]!='\\')pos++;
+        if(pos>=src.size()||src[pos]=='"'){Token t{TT::STRING,src.substr(start,pos-start),line};if(pos<src.size())pos++;return t;}
+        std::string s(src.substr(start,pos-start));
         while(pos<src.size()&&src[pos]!='"') {
-            if(src[pos]=='\\'){pos++; switch(src[pos]){case 'n':s+='\n';break;case 't':s+='\t';break;default:s+=src[pos];} pos++;}
+            if(src[pos]=='\\'){pos++; char e=peek(); switch(e){case 'n':s+='\n';break;case 't':s+='\t';break;default:s+=e;} pos++;}
             else s+=src[pos++];
         }
         if(pos<src.size())pos++;
-        return {TT::STRING,s,line};
+        unescaped.push_back(std::move(s));
+        return {TT::STRING,unescaped.back(),line};
     }
     Token makeNum() {
         size_t start=pos-1;
         while(pos<src.size()&&(std::isdigit(src[pos])||src[pos]=='.'))pos++;
         return {TT::NUMBER,src.substr(start,pos-start),line};
     }
-    Token makeIdent(char first) {
-        std::string s(1,first);
-        while(pos<src.size()&&(std::isalnum(src[pos])||src[pos]=='_'))s+=src[pos++];
-        auto it=kw.find(s);
-        return it!=kw.end()?Token{it->second,s,line}:Token{TT::IDENT,s,line};
+    Token makeIdent() {
+        size_t start=pos-1;
+        while(pos<src.size()&&(std::isalnum(src[pos])||src[pos]=='_'))pos++;
+        std::string_view s=src.substr(start,pos-start);
+        return {kw.find(s),s,line};
     }
 public:
-    Lexer(std::string source):src(std::move(source)){}
-    std::vector<Token> tokenize() {
-        std::vector<Token> tokens;
-        bool lastNL=true;
-        auto emitNL=[&](){ if(!lastNL){tokens.push_back({TT::NEWLINE,"\n",line});lastNL=true;} };
+    explicit Lexer(std::string_view source):src(source){}
+    // The next token; EOF_T forever once the source is used up
+    Token next() {
         while(pos<src.size()) {
             char c=advance();
             if(c==';'){skipComment();continue;}
-            if(c=='\n'){emitNL();continue;}
+            if(c=='\n'){if(!lastNL){lastNL=true;return {TT::NEWLINE,"\n",line};}continue;}
             if(c=='\r')continue;
             if(std::isspace(c))continue;
             lastNL=false;
-            if(c=='"'){tokens.push_back(makeStr());continue;}
-            if(std::isdigit(c)||(c=='-'&&std::isdigit(peek()))){tokens.push_back(makeNum());continue;}
-            if(std::isalpha(c)||c=='_'){tokens.push_back(makeIdent(c));continue;}
+            if(c=='"')return makeStr();
+            if(std::isdigit(c)||(c=='-'&&std::isdigit(peek())))return makeNum();
+            if(std::isalpha(c)||c=='_')return makeIdent();
             switch(c){
-                case '+':tokens.push_back({TT::PLUS,"+",line});break;
-                case '-':tokens.push_back({TT::MINUS,"-",line});break;
-                case '*':tokens.push_back({TT::STAR,"*",line});break;
-                case '/':tokens.push_back({TT::SLASH,"/",line});break;
-                case '%':tokens.push_back({TT::PERCENT,"%",line});break;
-                case '(':tokens.push_back({TT::LPAREN,"(",line});break;
-                case ')':tokens.push_back({TT::RPAREN,")",line});break;
-                case '[':tokens.push_back({TT::LBRACKET,"[",line});break;
-                case ']':tokens.push_back({TT::RBRACKET,"]",line});break;
-                case '{':tokens.push_back({TT::LBRACE,"{",line});break;
-                case '}':tokens.push_back({TT::RBRACE,"}",line});break;
-                case ',':tokens.push_back({TT::COMMA,",",line});break;
-                case '.':tokens.push_back({TT::DOT,".",line});break;
-                case ':':tokens.push_back({TT::COLON,":",line});break;
-                case '=': if(peek()=='='){pos++;tokens.push_back({TT::EQ,"==",line});}else tokens.push_back({TT::ASSIGN,"=",line});break;
-                case '!': if(peek()=='='){pos++;tokens.push_back({TT::NEQ,"!=",line});}break;
-                case '<': if(peek()=='='){pos++;tokens.push_back({TT::LEQ,"<=",line});}else tokens.push_back({TT::LT,"<",line});break;
-                case '>': if(peek()=='='){pos++;tokens.push_back({TT::GEQ,">=",line});}else tokens.push_back({TT::GT,">",line});break;
+                case '+':return {TT::PLUS,"+",line};
+                case '-':return {TT::MINUS,"-",line};
+                case '*':return {TT::STAR,"*",line};
+                case '/':return {TT::SLASH,"/",line};
+                case '%':return {TT::PERCENT,"%",line};
+                case '(':return {TT::LPAREN,"(",line};
+                case ')':return {TT::RPAREN,")",line};
+                case '[':return {TT::LBRACKET,src.substr(pos-1,1),line};  // in place: the parser checks what it touches
+                case ']':return {TT::RBRACKET,"]",line};
+                case '{':return {TT::LBRACE,"{",line};
+                case '}':return {TT::RBRACE,"}",line};
+                case ',':return {TT::COMMA,",",line};
+                case '.':return {TT::DOT,".",line};
+                case ':':return {TT::COLON,":",line};
+                case '=': if(peek()=='='){pos++;return {TT::EQ,"==",line};}return {TT::ASSIGN,"=",line};
+                case '!': if(peek()=='='){pos++;return {TT::NEQ,"!=",line};}break;
+                case '<': if(peek()=='='){pos++;return {TT::LEQ,"<=",line};}return {TT::LT,"<",line};
+                case '>': if(peek()=='='){pos++;return {TT::GEQ,">=",line};}return {TT::GT,">",line};
                 default:break;
             }
         }
-        emitNL();
-        tokens.push_back({TT::EOF_T,"",line});
-        return tokens;
+        if(!lastNL){lastNL=true;return {TT::NEWLINE,"\n",line};}
+        return {TT::EOF_T,"",line};
     }
 };
 
-const std::unordered_map<std::string,TT> Lexer::kw = {
+const KeywordTable Lexer::kw = {
     {"let",TT::LET},{"set",TT::SET},{"function",TT::FUNCTION},{"return",TT::RETURN},
     {"if",TT::IF},{"else",TT::ELSE},{"while",TT::WHILE},{"for",TT::FOR},{"each",TT::EACH},
     {"in",TT::IN_KW},{"break",TT::BREAK},{"continue",TT::CONTINUE},
@@ -194,6 +331,8 @@ const std::unordered_map<std::string,TT> Lexer::kw = {
     {"type",TT::TYPE_KW},{"then",TT::THEN},{"sort",TT::SORT_KW},{"json",TT::JSON_KW},{"parse",TT::PARSE_KW},
     // v3.1
     {"fetch",TT::FETCH_KW},{"run",TT::RUN_KW},
+    // v3.2
+    {"async",TT::ASYNC_KW},{"await",TT::AWAIT_KW},
 };
 
 // ============================================================
@@ -209,8 +348,10 @@ struct NumberLit    { double value; };
 struct StringLit    { std::string value; };
 struct BoolLit      { bool value; };
 struct NullLit      {};
-struct ArrayLit     { std::vector<ExprPtr> elems; };
-struct ObjectLit    { std::vector<std::pair<std::string,ExprPtr>> pairs; };
+struct IronValue;
+// v3.2: 'constant' is a prebuilt value the optimizer fills in when every element is a literal (not cached)
+struct ArrayLit     { std::vector<ExprPtr> elems; std::shared_ptr<IronValue> constant{}; };
+struct ObjectLit    { std::vector<std::pair<std::string,ExprPtr>> pairs; std::shared_ptr<IronValue> constant{}; };
 struct VarExpr      { std::string name; };
 struct BinExpr      { std::string op; ExprPtr left, right; };
 struct UnaryExpr    { std::string op; ExprPtr operand; };
@@ -245,12 +386,21 @@ struct LowerExpr    { ExprPtr str; };              // lowercase str
 struct SubstrExpr   { ExprPtr str, from, to; };    // chars i to j of str
 // v3.0 misc
 struct TypeOfExpr   { ExprPtr val; };              // type of x
-struct SortExpr     { ExprPtr arr; ExprPtr key; }; // sort arr [by fn]
+struct SortExpr     { ExprPtr arr; std::vector<std::pair<ExprPtr,bool>> keys; }; // sort arr [by key [descending]] [then key ...]
+                                                   // (key, descending); a null key sorts by the items themselves
 struct ParseJsonExpr{ ExprPtr str; };              // parse json str
 struct JsonOfExpr   { ExprPtr val; };              // json of val
 // v3.1 networking + subprocess
-struct FetchExpr    { ExprPtr url; ExprPtr opts; };// fetch "url" [with {...}]
-struct RunExpr      { ExprPtr cmd; };              // run "cmd"
+struct FetchExpr    { ExprPtr url; ExprPtr opts; bool async{false}; ExprPtr toFile{}; };// [async] fetch "url" [with {...}] [to file p]
+struct RunExpr      { ExprPtr cmd; ExprPtr opts; bool all{false}; };// run "cmd" | run ["prog", "arg"] [with {input}] | run all [cmds] [with {parallel}]
+// v3.2 async fetch
+struct AwaitExpr    { ExprPtr val; };              // await handle | await [handles] | await fetch ...
+// v3.2 number-list reductions
+struct ReduceExpr   { std::string op; ExprPtr list; }; // sum / min / max / average of list
+// v3.2 CSV
+struct CsvExpr      { ExprPtr src; ExprPtr opts; bool file{false}; }; // parse csv text | csv file "p"  [with {header, separator}]
+struct CsvOfExpr    { ExprPtr val; ExprPtr opts; };                    // csv of rows  [with {columns}]
+struct MemoryExpr   {};                                                // v3.2: memory used → bytes
 // ask as expression
 struct AskExpr      { ExprPtr prompt; };           // ask "prompt"
 
@@ -266,7 +416,8 @@ struct Expr {
         SplitExpr,JoinExpr,TrimExpr,ReplaceExpr,IndexOfExpr,
         UpperExpr,LowerExpr,SubstrExpr,
         TypeOfExpr,SortExpr,ParseJsonExpr,JsonOfExpr,
-        FetchExpr,RunExpr,AskExpr
+        FetchExpr,RunExpr,AskExpr,AwaitExpr,ReduceExpr,
+        CsvExpr,CsvOfExpr,MemoryExpr
     > node;
 };
 
@@ -284,7 +435,7 @@ struct WhileStmt    { ExprPtr cond; StmtList body; };
 struct ForStmt      { std::string var; ExprPtr iterable; StmtList body; };
 struct BreakStmt    {};
 struct ContinueStmt {};
-struct ReturnStmt   { ExprPtr value; };
+struct ReturnStmt   { ExprPtr value; bool tail=false; };  // v3.2: tail = 'return f(...)' that can reuse the frame
 struct FuncStmt     { std::string name; std::vector<std::string> params; StmtList body; };
 struct CallStmt     { ExprPtr call; };
 struct GetStmt      { std::string path, alias; };
@@ -297,6 +448,10 @@ struct ThrowStmt    { ExprPtr value; };
 // v2.0 Scratch-style file I/O statements
 struct WriteFileStmt  { ExprPtr content; ExprPtr path; }; // write <content> to file <path>
 struct AppendFileStmt { ExprPtr content; ExprPtr path; }; // append <content> to file <path>
+// v3.2 counting loop
+struct ForRangeStmt { std::string var; ExprPtr from, to, step; StmtList body; }; // for i from a to b [by s]
+// v3.2 HTTP server
+struct ServeStmt    { ExprPtr port; ExprPtr handler; };  // serve on port N with handler | with {handler, workers, host}
 
 struct Stmt {
     std::variant<
@@ -304,8 +459,9 @@ struct Stmt {
         IfStmt,WhileStmt,ForStmt,BreakStmt,ContinueStmt,ReturnStmt,
         FuncStmt,CallStmt,GetStmt,ExprStmt,AddToStmt,
         ClassStmt,TryStmt,ThrowStmt,
-        WriteFileStmt,AppendFileStmt
+        WriteFileStmt,AppendFileStmt,ForRangeStmt,ServeStmt
     > node;
+    int line{0};  // v3.2: source line, for errors raised while it runs
 };
 
 // ============================================================
@@ -313,15 +469,20 @@ struct Stmt {
 // ============================================================
 
 class Parser {
-    std::vector<Token> tokens;
-    size_t pos{0};
+    // v3.2: tokens are pulled from the lexer into a small ring as the parser looks ahead
+    // (never more than peek(2)); pos counts tokens consumed, filled tokens pulled
+    static constexpr size_t LOOKAHEAD=4;
+    Lexer lexer;
+    std::array<Token,LOOKAHEAD> ring{};
+    size_t pos{0},filled{0};
+    int funcDepth{0},tryDepth{0};  // v3.2: where a 'return' sits, for tail-call marking
 
-    Token& peek(int off=0){return tokens[std::min(pos+(size_t)off,tokens.size()-1)];}
-    Token  consume(){return tokens[pos++];}
+    Token& peek(int off=0){while(filled<=pos+off)ring[filled++%LOOKAHEAD]=lexer.next();return ring[(pos+off)%LOOKAHEAD];}
+    Token  consume(){Token t=peek();pos++;return t;}
     bool   check(TT t,int off=0){return peek(off).type==t;}
     bool   match(TT t){if(check(t)){pos++;return true;}return false;}
     Token  expect(TT t,const std::string& msg){
-        if(!check(t))throw std::runtime_error("Line "+std::to_string(peek().line)+": "+msg+" (got '"+peek().val+"')");
+        if(!check(t))throw std::runtime_error("Line "+std::to_string(peek().line)+": "+msg+" (got '"+std::string(peek().val)+"')");
         return consume();
     }
     // Scratch-style contextual keywords can also be used as variable/parameter names
@@ -333,12 +494,22 @@ class Parser {
             TT::SPLIT_KW,TT::BY,TT::JOIN_KW,TT::WITH,TT::TRIM_KW,
             TT::REPLACE_KW,TT::INDEX_KW,TT::UPPER_KW,TT::LOWER_KW,TT::CHARS_KW,TT::FROM,
             TT::TYPE_KW,TT::THEN,TT::SORT_KW,TT::JSON_KW,TT::PARSE_KW,
-            TT::FETCH_KW,TT::RUN_KW
+            TT::FETCH_KW,TT::RUN_KW,TT::ASYNC_KW,TT::AWAIT_KW
         };
         return ctx.count(peek().type)>0;
     }
+    // v3.2: whether a word like "await" has an operand after it, or is a plain variable that
+    // the next token ends or applies an operator to (say await + 1)
+    bool operandAfter(int off){
+        static const std::unordered_set<TT> noOperand={
+            TT::NEWLINE,TT::EOF_T,TT::RPAREN,TT::RBRACKET,TT::RBRACE,TT::COMMA,TT::DOT,TT::COLON,
+            TT::PLUS,TT::STAR,TT::SLASH,TT::PERCENT,TT::EQ,TT::NEQ,TT::LT,TT::GT,TT::LEQ,TT::GEQ,
+            TT::ASSIGN,TT::AND,TT::OR,TT::THEN,TT::TO,TT::BY,TT::WITH
+        };
+        return !noOperand.count(peek(off+1).type);
+    }
     Token expectName(const std::string& msg){
-        if(!isName())throw std::runtime_error("Line "+std::to_string(peek().line)+": "+msg+" (got '"+peek().val+"')");
+        if(!isName())throw std::runtime_error("Line "+std::to_string(peek().line)+": "+msg+" (got '"+std::string(peek().val)+"')");
         return consume();
     }
     void skipNL(){while(check(TT::NEWLINE))pos++;}
@@ -361,22 +532,22 @@ class Parser {
     }
     ExprPtr parseEquality(){
         auto l=parseComparison();
-        while(check(TT::EQ)||check(TT::NEQ)){auto op=consume().val;auto r=parseComparison();l=makeExpr(BinExpr{op,std::move(l),std::move(r)});}
+        while(check(TT::EQ)||check(TT::NEQ)){std::string op(consume().val);auto r=parseComparison();l=makeExpr(BinExpr{op,std::move(l),std::move(r)});}
         return l;
     }
     ExprPtr parseComparison(){
         auto l=parseAddSub();
-        while(check(TT::LT)||check(TT::GT)||check(TT::LEQ)||check(TT::GEQ)){auto op=consume().val;auto r=parseAddSub();l=makeExpr(BinExpr{op,std::move(l),std::move(r)});}
+        while(check(TT::LT)||check(TT::GT)||check(TT::LEQ)||check(TT::GEQ)){std::string op(consume().val);auto r=parseAddSub();l=makeExpr(BinExpr{op,std::move(l),std::move(r)});}
         return l;
     }
     ExprPtr parseAddSub(){
         auto l=parseMulDiv();
-        while(check(TT::PLUS)||check(TT::MINUS)){auto op=consume().val;auto r=parseMulDiv();l=makeExpr(BinExpr{op,std::move(l),std::move(r)});}
+        while(check(TT::PLUS)||check(TT::MINUS)){std::string op(consume().val);auto r=parseMulDiv();l=makeExpr(BinExpr{op,std::move(l),std::move(r)});}
         return l;
     }
     ExprPtr parseMulDiv(){
         auto l=parseUnary();
-        while(check(TT::STAR)||check(TT::SLASH)||check(TT::PERCENT)){auto op=consume().val;auto r=parseUnary();l=makeExpr(BinExpr{op,std::move(l),std::move(r)});}
+        while(check(TT::STAR)||check(TT::SLASH)||check(TT::PERCENT)){std::string op(consume().val);auto r=parseUnary();l=makeExpr(BinExpr{op,std::move(l),std::move(r)});}
         return l;
     }
     ExprPtr parseUnary(){
@@ -389,7 +560,7 @@ class Parser {
         while(true){
             if(check(TT::DOT)){
                 consume();
-                auto name=expect(TT::IDENT,"Expected field name after '.'").val;
+                std::string name(expect(TT::IDENT,"Expected field name after '.'").val);
                 if(check(TT::LPAREN)){
                     consume();
                     std::vector<ExprPtr> args;
@@ -429,7 +600,7 @@ class Parser {
                 return makeExpr(ItemOfExpr{std::move(idx),parsePostfix()});
             }
             // otherwise: treat "item" as a plain variable name
-            return makeExpr(VarExpr{consume().val});
+            return makeExpr(VarExpr{std::string(consume().val)});
         }
         // Scratch-style: keep items in <arr> where <fn>
         if(check(TT::KEEP)){
@@ -465,6 +636,12 @@ class Parser {
             consume();consume();
             return makeExpr(FileExistsExpr{parsePostfix()});
         }
+        // v3.2: sum of / min of / max of / average of <list>
+        if(check(TT::IDENT) && check(TT::OF,1) &&
+           (peek().val=="sum"||peek().val=="min"||peek().val=="max"||peek().val=="average")){
+            std::string op(consume().val);consume();
+            return makeExpr(ReduceExpr{op,parsePostfix()});
+        }
         // lines of file <path>  (mirrors "length of arr")
         if(check(TT::IDENT) && peek().val=="lines" && check(TT::OF,1) && check(TT::FILE_KW,2)){
             consume();consume();consume();
@@ -476,9 +653,9 @@ class Parser {
             consume(); // "function"
             expect(TT::LPAREN,"Expected '('");
             std::vector<std::string> params;
-            if(!check(TT::RPAREN)){params.push_back(expectName("Expected param").val);while(match(TT::COMMA))params.push_back(expectName("Expected param").val);}
+            if(!check(TT::RPAREN)){params.push_back(std::string(expectName("Expected param").val));while(match(TT::COMMA))params.push_back(std::string(expectName("Expected param").val));}
             expect(TT::RPAREN,"Expected ')'");expectNL();
-            auto body=parseBlock([&]{return check(TT::END);});
+            auto body=parseFuncBody();
             expect(TT::END,"Expected 'end' after function");
             return makeExpr(FuncExpr{std::move(params),std::move(body)});
         }
@@ -538,35 +715,87 @@ class Parser {
         // v3.0: type of x
         if(check(TT::TYPE_KW) && check(TT::OF,1)){consume();consume();return makeExpr(TypeOfExpr{parsePostfix()});}
         // v3.0: sort arr / sort arr by field / sort arr by function(x)...end
+        // v3.2: ... [ascending|descending] [then [by] key [descending] ...]
         if(check(TT::SORT_KW)){
             consume();auto arr=parsePostfix();
-            if(!check(TT::BY))return makeExpr(SortExpr{std::move(arr),nullptr});
+            SortExpr se{std::move(arr),{}};
+            if(!check(TT::BY)){
+                if(sortDirection())se.keys.push_back({nullptr,true});
+                return makeExpr(std::move(se));
+            }
             consume(); // "by"
-            // bare identifier → field name shorthand  e.g.  sort people by age
-            if(isName()&&!check(TT::FUNCTION)){
-                auto field=consume().val;
+            do{
+                match(TT::BY);  // "then by age" reads as well as "then age"
+                ExprPtr key;
+                // bare identifier → field name shorthand  e.g.  sort people by age
                 // encode as StringLit so the evaluator knows it's a field key
-                return makeExpr(SortExpr{std::move(arr),makeExpr(StringLit{field})});
-            }
-            // full lambda for computed keys  e.g.  sort people by function(x) return -x.score end
-            return makeExpr(SortExpr{std::move(arr),parsePostfix()});
+                if(isName()&&!check(TT::FUNCTION))key=makeExpr(StringLit{std::string(consume().val)});
+                // full lambda for computed keys  e.g.  sort people by function(x) return -x.score end
+                else key=parsePostfix();
+                se.keys.push_back({std::move(key),sortDirection()});
+            }while(match(TT::THEN));
+            return makeExpr(std::move(se));
         }
         // v3.0: parse json str
         if(check(TT::PARSE_KW) && check(TT::JSON_KW,1)){consume();consume();return makeExpr(ParseJsonExpr{parsePostfix()});}
         // v3.0: json of val
         if(check(TT::JSON_KW) && check(TT::OF,1)){consume();consume();return makeExpr(JsonOfExpr{parsePostfix()});}
+        // v3.2: parse csv text / csv file "path"  [with {header: true, separator: ";"}]  /  csv of rows  [with {columns: [...]}]
+        bool csvFile=check(TT::IDENT)&&peek().val=="csv"&&check(TT::FILE_KW,1);
+        if(csvFile||(check(TT::PARSE_KW)&&check(TT::IDENT,1)&&peek(1).val=="csv")){
+            consume();consume();
+            CsvExpr ce{parsePostfix(),nullptr,csvFile};
+            if(match(TT::WITH))ce.opts=parsePostfix();
+            return makeExpr(std::move(ce));
+        }
+        if(check(TT::IDENT)&&peek().val=="csv"&&check(TT::OF,1)){
+            consume();consume();
+            CsvOfExpr co{parsePostfix(),nullptr};
+            if(match(TT::WITH))co.opts=parsePostfix();
+            return makeExpr(std::move(co));
+        }
+        // v3.2: memory used → bytes the script has allocated
+        if(check(TT::IDENT)&&peek().val=="memory"&&check(TT::IDENT,1)&&peek(1).val=="used"){consume();consume();return makeExpr(MemoryExpr{});}
         // v3.1: fetch "url" [with options]
         if(check(TT::FETCH_KW)){
             consume();auto url=parsePostfix();
             ExprPtr opts;
             if(check(TT::WITH)){consume();opts=parsePostfix();}
-            return makeExpr(FetchExpr{std::move(url),std::move(opts)});
+            FetchExpr fe{std::move(url),std::move(opts)};
+            // v3.2: ... to file "path"  → stream the body to disk instead of into memory
+            if(check(TT::TO) && check(TT::FILE_KW,1)){consume();consume();fe.toFile=parsePostfix();}
+            return makeExpr(std::move(fe));
         }
         // v3.1: run "cmd"
-        if(check(TT::RUN_KW)){consume();return makeExpr(RunExpr{parsePostfix()});}
+        if(check(TT::RUN_KW)){
+            consume();
+            // v3.2: run all <list> [with {parallel: N}]  ("all" stays usable as a variable:
+            // run all, run all[0], run all.cmd, run all(x), run all + "x" — a '[' right after
+            // the word indexes it, one after a space starts the list: run all ["a", "b"])
+            bool all=check(TT::IDENT)&&peek().val=="all"&&operandAfter(0)&&!check(TT::LPAREN,1)&&!check(TT::MINUS,1)
+                &&!(check(TT::LBRACKET,1)&&peek(1).val.data()==peek().val.data()+peek().val.size());
+            if(all)consume();
+            auto cmd=parsePostfix();
+            ExprPtr opts;
+            if(check(TT::WITH)){consume();opts=parsePostfix();}
+            return makeExpr(RunExpr{std::move(cmd),std::move(opts),all});
+        }
+        // v3.2: async fetch "url" [with options]  → pending handle
+        if(check(TT::ASYNC_KW) && check(TT::FETCH_KW,1)){
+            consume();auto e=parsePrimary();
+            std::get<FetchExpr>(e->node).async=true;
+            return e;
+        }
+        if(check(TT::ASYNC_KW)){return makeExpr(VarExpr{std::string(consume().val)});}
+        // v3.2: await <handle | list of handles | fetch ...>
+        // ("await" with nothing to wait on after it is a plain variable: let await = 1 ... say await + 1)
+        if(check(TT::AWAIT_KW)){
+            if(!operandAfter(0))return makeExpr(VarExpr{std::string(consume().val)});
+            consume();return makeExpr(AwaitExpr{parsePostfix()});
+        }
         // v2.0: new ClassName(args)
         if(check(TT::NEW_KW)){
-            consume();auto name=expectName("Expected class name after 'new'").val;
+            consume();std::string name(expectName("Expected class name after 'new'").val);
             std::vector<ExprPtr> args;
             if(match(TT::LPAREN)){
                 if(!check(TT::RPAREN)){args.push_back(parseExpr());while(match(TT::COMMA))args.push_back(parseExpr());}
@@ -585,12 +814,12 @@ class Parser {
             else prompt=makeExpr(StringLit{""});
             return makeExpr(AskExpr{std::move(prompt)});
         }
-        if(check(TT::NUMBER)) {auto v=consume().val;return makeExpr(NumberLit{std::stod(v)});}
-        if(check(TT::STRING)) {auto v=consume().val;return makeExpr(StringLit{v});}
+        if(check(TT::NUMBER)) {std::string v(consume().val);return makeExpr(NumberLit{std::stod(v)});}
+        if(check(TT::STRING)) {return makeExpr(StringLit{std::string(consume().val)});}
         if(check(TT::TRUE_KW)){consume();return makeExpr(BoolLit{true});}
         if(check(TT::FALSE_KW)){consume();return makeExpr(BoolLit{false});}
         if(check(TT::NULL_KW)){consume();return makeExpr(NullLit{});}
-        if(check(TT::IDENT))  {return makeExpr(VarExpr{consume().val});}
+        if(check(TT::IDENT))  {return makeExpr(VarExpr{std::string(consume().val)});}
         if(check(TT::LPAREN)) {consume();auto e=parseExpr();expect(TT::RPAREN,"Expected ')'");return e;}
         if(check(TT::LBRACKET)){
             consume();std::vector<ExprPtr> elems;skipNL();
@@ -601,14 +830,20 @@ class Parser {
         if(check(TT::LBRACE)){
             consume();std::vector<std::pair<std::string,ExprPtr>> pairs;skipNL();
             if(!check(TT::RBRACE)){
-                auto k=expect(TT::IDENT,"Expected key").val;expect(TT::COLON,"Expected ':'");
+                std::string k(expect(TT::IDENT,"Expected key").val);expect(TT::COLON,"Expected ':'");
                 auto v=parseExpr();pairs.push_back({k,std::move(v)});
-                while(match(TT::COMMA)){skipNL();auto k2=expect(TT::IDENT,"Expected key").val;expect(TT::COLON,"Expected ':'");pairs.push_back({k2,parseExpr()});}
+                while(match(TT::COMMA)){skipNL();std::string k2(expect(TT::IDENT,"Expected key").val);expect(TT::COLON,"Expected ':'");pairs.push_back({k2,parseExpr()});}
             }
             skipNL();expect(TT::RBRACE,"Expected '}'");
             return makeExpr(ObjectLit{std::move(pairs)});
         }
-        throw std::runtime_error("Line "+std::to_string(peek().line)+": Unexpected token '"+peek().val+"'");
+        throw std::runtime_error("Line "+std::to_string(peek().line)+": Unexpected token '"+std::string(peek().val)+"'");
+    }
+
+    // optional 'ascending' / 'descending' after a sort key; true = descending
+    bool sortDirection(){
+        if(check(TT::IDENT)&&(peek().val=="ascending"||peek().val=="descending"))return consume().val=="descending";
+        return false;
     }
 
     // ---- Statements ----
@@ -617,12 +852,25 @@ class Parser {
         while(!end()&&!check(TT::EOF_T)){s.push_back(parseStmt());skipNL();}
         return s;
     }
+    // a function body starts a fresh frame: a 'try' around the definition doesn't cover its returns
+    StmtList parseFuncBody(){
+        int fd=funcDepth,td=tryDepth;funcDepth++;tryDepth=0;
+        auto body=parseBlock([&]{return check(TT::END);});
+        funcDepth=fd;tryDepth=td;
+        return body;
+    }
 
     StmtPtr parseStmt(){
         skipNL();
+        int line=peek().line;
+        auto s=parseStmtAt();
+        s->line=line;
+        return s;
+    }
+    StmtPtr parseStmtAt(){
         switch(peek().type){
             case TT::LET:{
-                consume();auto name=expectName("Expected variable name").val;
+                consume();std::string name(expectName("Expected variable name").val);
                 ExprPtr init;if(match(TT::ASSIGN))init=parseExpr();else init=makeExpr(NullLit{});
                 expectNL();return makeStmt(LetStmt{name,std::move(init)});
             }
@@ -638,7 +886,7 @@ class Parser {
             }
             case TT::SAY:{consume();auto e=parseExpr();expectNL();return makeStmt(SayStmt{std::move(e)});}
             case TT::ASK:{
-                consume();auto name=expectName("Expected variable name").val;
+                consume();std::string name(expectName("Expected variable name").val);
                 ExprPtr prompt;
                 if(!check(TT::NEWLINE)&&!check(TT::EOF_T))prompt=parseExpr();
                 else prompt=makeExpr(StringLit{""});
@@ -660,7 +908,18 @@ class Parser {
             }
             case TT::FOR:{
                 consume();match(TT::EACH);
-                auto var=expectName("Expected variable name").val;
+                std::string var(expectName("Expected variable name").val);
+                // v3.2: for i from a to b [by step] — counts without building a list
+                if(match(TT::FROM)){
+                    auto from=parseExpr();
+                    expect(TT::TO,"Expected 'to'  (usage: for i from 1 to 10 [by 2])");
+                    auto to=parseExpr();
+                    ExprPtr step;if(match(TT::BY))step=parseExpr();
+                    expectNL();
+                    auto body=parseBlock([&]{return check(TT::END);});
+                    expect(TT::END,"Expected 'end' after for");expectNL();
+                    return makeStmt(ForRangeStmt{var,std::move(from),std::move(to),std::move(step),std::move(body)});
+                }
                 expect(TT::IN_KW,"Expected 'in'");auto iter=parseExpr();expectNL();
                 auto body=parseBlock([&]{return check(TT::END);});
                 expect(TT::END,"Expected 'end' after for");expectNL();
@@ -671,29 +930,31 @@ class Parser {
             case TT::RETURN:{
                 consume();ExprPtr val;
                 if(!check(TT::NEWLINE)&&!check(TT::EOF_T))val=parseExpr();else val=makeExpr(NullLit{});
-                expectNL();return makeStmt(ReturnStmt{std::move(val)});
+                // v3.2: 'return f(...)' in a function (outside a try body) is a tail call
+                bool tail=funcDepth>0&&tryDepth==0&&std::holds_alternative<CallExpr>(val->node);
+                expectNL();return makeStmt(ReturnStmt{std::move(val),tail});
             }
             case TT::FUNCTION:{
                 // function(params) → lambda expression used as a statement value
                 if(check(TT::LPAREN,1))break; // fall to default → parseExpr
-                consume();auto name=expectName("Expected function name").val;
+                consume();std::string name(expectName("Expected function name").val);
                 expect(TT::LPAREN,"Expected '('");
                 std::vector<std::string> params;
-                if(!check(TT::RPAREN)){params.push_back(expectName("Expected param").val);while(match(TT::COMMA))params.push_back(expectName("Expected param").val);}
+                if(!check(TT::RPAREN)){params.push_back(std::string(expectName("Expected param").val));while(match(TT::COMMA))params.push_back(std::string(expectName("Expected param").val));}
                 expect(TT::RPAREN,"Expected ')'");expectNL();
-                auto body=parseBlock([&]{return check(TT::END);});
+                auto body=parseFuncBody();
                 expect(TT::END,"Expected 'end' after function");expectNL();
                 return makeStmt(FuncStmt{name,params,std::move(body)});
             }
             case TT::CALL:{consume();auto e=parseExpr();expectNL();return makeStmt(CallStmt{std::move(e)});}
             case TT::GET:{
-                consume();auto path=expect(TT::STRING,"Expected module path").val;
-                expect(TT::AS,"Expected 'as'");auto alias=expectName("Expected alias").val;
+                consume();std::string path(expect(TT::STRING,"Expected module path").val);
+                expect(TT::AS,"Expected 'as'");std::string alias(expectName("Expected alias").val);
                 expectNL();return makeStmt(GetStmt{path,alias});
             }
             // v2.0: class
             case TT::CLASS:{
-                consume();auto name=expectName("Expected class name").val;expectNL();
+                consume();std::string name(expectName("Expected class name").val);expectNL();
                 auto body=parseBlock([&]{return check(TT::END);});
                 expect(TT::END,"Expected 'end' after class");expectNL();
                 return makeStmt(ClassStmt{name,std::move(body)});
@@ -701,9 +962,9 @@ class Parser {
             // v2.0: try/catch
             case TT::TRY:{
                 consume();expectNL();
-                auto body=parseBlock([&]{return check(TT::CATCH);});
+                tryDepth++;auto body=parseBlock([&]{return check(TT::CATCH);});tryDepth--;
                 expect(TT::CATCH,"Expected 'catch' after try block");
-                auto errVar=expectName("Expected error variable name after 'catch'").val;
+                std::string errVar(expectName("Expected error variable name after 'catch'").val);
                 expectNL();
                 auto catchBody=parseBlock([&]{return check(TT::END);});
                 expect(TT::END,"Expected 'end' after catch");expectNL();
@@ -730,13 +991,23 @@ class Parser {
                 auto path=parseExpr();expectNL();
                 return makeStmt(AppendFileStmt{std::move(content),std::move(path)});
             }
+            // v3.2: serve on port <expr> with <handler>
+            case TT::IDENT:{
+                if(peek().val!="serve"||!check(TT::IDENT,1)||peek(1).val!="on")break;
+                consume();consume();
+                if(!check(TT::IDENT)||peek().val!="port")throw std::runtime_error("Line "+std::to_string(peek().line)+": Expected 'port' after 'serve on' (got '"+std::string(peek().val)+"')");
+                consume();auto port=parseExpr();
+                expect(TT::WITH,"Expected 'with' after the port  (usage: serve on port 8080 with handler)");
+                auto handler=parseExpr();expectNL();
+                return makeStmt(ServeStmt{std::move(port),std::move(handler)});
+            }
             default:{auto e=parseExpr();expectNL();return makeStmt(ExprStmt{std::move(e)});}
         }
         // Reached only when a case breaks instead of returns (e.g. lambda fallthrough)
         auto e=parseExpr();expectNL();return makeStmt(ExprStmt{std::move(e)});
     }
 public:
-    Parser(std::vector<Token> toks):tokens(std::move(toks)){}
+    explicit Parser(std::string_view source):lexer(source){}
     StmtList parse(){
         StmtList p;skipNL();
         while(!check(TT::EOF_T)){p.push_back(parseStmt());skipNL();}
@@ -745,14 +1016,324 @@ public:
 };
 
 // ============================================================
-//  VALUES
+//  AST CACHE  (v3.2)
+//  A parsed program is saved as a compact binary .irwc file next to
+//  its source (or in $IRONWOOD_CACHE_DIR), keyed by a hash of the
+//  source text. An unchanged file is loaded from it instead of being
+//  lexed and parsed again. Every AST node lists its fields once in
+//  astIO(); the same function both writes and reads them.
+// ============================================================
+
+static bool useAstCache=true;   // --no-cache turns it off
+static int  optLevel=1;         // -O0 runs the tree exactly as parsed; -O1 folds constants first
+
+template<class A> void astIO(A& a,NumberLit& n)      {a(n.value);}
+template<class A> void astIO(A& a,StringLit& n)      {a(n.value);}
+template<class A> void astIO(A& a,BoolLit& n)        {a(n.value);}
+template<class A> void astIO(A&,NullLit&)            {}
+template<class A> void astIO(A& a,ArrayLit& n)       {a(n.elems);}
+template<class A> void astIO(A& a,ObjectLit& n)      {a(n.pairs);}
+template<class A> void astIO(A& a,VarExpr& n)        {a(n.name);}
+template<class A> void astIO(A& a,BinExpr& n)        {a(n.op,n.left,n.right);}
+template<class A> void astIO(A& a,UnaryExpr& n)      {a(n.op,n.operand);}
+template<class A> void astIO(A& a,IndexExpr& n)      {a(n.obj,n.index);}
+template<class A> void astIO(A& a,MemberExpr& n)     {a(n.obj,n.field);}
+template<class A> void astIO(A& a,CallExpr& n)       {a(n.callee,n.args);}
+template<class A> void astIO(A& a,LengthOfExpr& n)   {a(n.arr);}
+template<class A> void astIO(A& a,ItemOfExpr& n)     {a(n.index,n.arr);}
+template<class A> void astIO(A& a,KeepWhereExpr& n)  {a(n.arr,n.fn);}
+template<class A> void astIO(A& a,ClassNewExpr& n)   {a(n.className,n.args);}
+template<class A> void astIO(A& a,HasExpr& n)        {a(n.item,n.collection);}
+template<class A> void astIO(A& a,KeysOfExpr& n)     {a(n.dict);}
+template<class A> void astIO(A& a,ValuesOfExpr& n)   {a(n.dict);}
+template<class A> void astIO(A& a,ReadFileExpr& n)   {a(n.path);}
+template<class A> void astIO(A& a,FileExistsExpr& n) {a(n.path);}
+template<class A> void astIO(A& a,LinesOfFileExpr& n){a(n.path);}
+template<class A> void astIO(A& a,FuncExpr& n)       {a(n.params,n.body);}
+template<class A> void astIO(A& a,TernaryExpr& n)    {a(n.cond,n.thenE,n.elseE);}
+template<class A> void astIO(A& a,SplitExpr& n)      {a(n.str,n.sep);}
+template<class A> void astIO(A& a,JoinExpr& n)       {a(n.arr,n.sep);}
+template<class A> void astIO(A& a,TrimExpr& n)       {a(n.str);}
+template<class A> void astIO(A& a,ReplaceExpr& n)    {a(n.str,n.from,n.to);}
+template<class A> void astIO(A& a,IndexOfExpr& n)    {a(n.sub,n.str);}
+template<class A> void astIO(A& a,UpperExpr& n)      {a(n.str);}
+template<class A> void astIO(A& a,LowerExpr& n)      {a(n.str);}
+template<class A> void astIO(A& a,SubstrExpr& n)     {a(n.str,n.from,n.to);}
+template<class A> void astIO(A& a,TypeOfExpr& n)     {a(n.val);}
+template<class A> void astIO(A& a,SortExpr& n)       {a(n.arr,n.keys);}
+template<class A> void astIO(A& a,ParseJsonExpr& n)  {a(n.str);}
+template<class A> void astIO(A& a,JsonOfExpr& n)     {a(n.val);}
+template<class A> void astIO(A& a,FetchExpr& n)      {a(n.url,n.opts,n.async,n.toFile);}
+template<class A> void astIO(A& a,RunExpr& n)        {a(n.cmd,n.opts,n.all);}
+template<class A> void astIO(A& a,AskExpr& n)        {a(n.prompt);}
+template<class A> void astIO(A& a,AwaitExpr& n)      {a(n.val);}
+template<class A> void astIO(A& a,ReduceExpr& n)     {a(n.op,n.list);}
+template<class A> void astIO(A& a,CsvExpr& n)        {a(n.src,n.opts,n.file);}
+template<class A> void astIO(A& a,CsvOfExpr& n)      {a(n.val,n.opts);}
+template<class A> void astIO(A&,MemoryExpr&)         {}
+
+template<class A> void astIO(A& a,LetStmt& n)        {a(n.name,n.init);}
+template<class A> void astIO(A& a,SetStmt& n)        {a(n.target,n.value);}
+template<class A> void astIO(A& a,SayStmt& n)        {a(n.expr);}
+template<class A> void astIO(A& a,AskStmt& n)        {a(n.varName,n.prompt);}
+template<class A> void astIO(A&,PauseStmt&)          {}
+template<class A> void astIO(A& a,IfStmt& n)         {a(n.cond,n.thenBody,n.elseBody);}
+template<class A> void astIO(A& a,WhileStmt& n)      {a(n.cond,n.body);}
+template<class A> void astIO(A& a,ForStmt& n)        {a(n.var,n.iterable,n.body);}
+template<class A> void astIO(A& a,ForRangeStmt& n)   {a(n.var,n.from,n.to,n.step,n.body);}
+template<class A> void astIO(A&,BreakStmt&)          {}
+template<class A> void astIO(A&,ContinueStmt&)       {}
+template<class A> void astIO(A& a,ReturnStmt& n)     {a(n.value,n.tail);}
+template<class A> void astIO(A& a,FuncStmt& n)       {a(n.name,n.params,n.body);}
+template<class A> void astIO(A& a,CallStmt& n)       {a(n.call);}
+template<class A> void astIO(A& a,GetStmt& n)        {a(n.path,n.alias);}
+template<class A> void astIO(A& a,ExprStmt& n)       {a(n.expr);}
+template<class A> void astIO(A& a,AddToStmt& n)      {a(n.value,n.target);}
+template<class A> void astIO(A& a,ClassStmt& n)      {a(n.name,n.body);}
+template<class A> void astIO(A& a,TryStmt& n)        {a(n.body,n.catchVar,n.catchBody);}
+template<class A> void astIO(A& a,ThrowStmt& n)      {a(n.value);}
+template<class A> void astIO(A& a,WriteFileStmt& n)  {a(n.content,n.path);}
+template<class A> void astIO(A& a,AppendFileStmt& n) {a(n.content,n.path);}
+template<class A> void astIO(A& a,ServeStmt& n)      {a(n.port,n.handler);}
+
+struct AstWriter {
+    std::string out;
+    void varint(uint64_t v){while(v>=0x80){out+=char(v|0x80);v>>=7;}out+=char(v);}
+    void operator()(double& d){out.append((const char*)&d,sizeof d);}
+    void operator()(bool& b){out+=char(b);}
+    void operator()(std::string& s){varint(s.size());out+=s;}
+    template<class N> void operator()(std::unique_ptr<N>& p){
+        // 0 = null, otherwise variant index + 1, then the node's fields
+        if(!p){varint(0);return;}
+        varint(p->node.index()+1);
+        if constexpr(std::is_same_v<N,Stmt>)varint(p->line);
+        std::visit([&](auto& n){astIO(*this,n);},p->node);
+    }
+    template<class T> void operator()(std::vector<T>& v){varint(v.size());for(auto&x:v)(*this)(x);}
+    template<class X,class Y> void operator()(std::pair<X,Y>& p){(*this)(p.first);(*this)(p.second);}
+    template<class T,class U,class... R> void operator()(T& a,U& b,R&... rest){(*this)(a);(*this)(b,rest...);}
+};
+
+struct AstReader {
+    const std::string& in;
+    size_t pos{0};
+    explicit AstReader(const std::string& s,size_t start=0):in(s),pos(start){}
+    uint64_t varint(){
+        uint64_t v=0;int shift=0;
+        while(true){
+            if(pos>=in.size()||shift>63)throw std::runtime_error("Truncated AST cache");
+            unsigned char c=in[pos++];v|=(uint64_t)(c&0x7f)<<shift;
+            if(!(c&0x80))return v;
+            shift+=7;
+        }
+    }
+    void need(size_t n){if(in.size()-pos<n)throw std::runtime_error("Truncated AST cache");}
+    void operator()(double& d){need(sizeof d);std::memcpy(&d,in.data()+pos,sizeof d);pos+=sizeof d;}
+    void operator()(bool& b){need(1);b=in[pos++]!=0;}
+    void operator()(std::string& s){size_t n=varint();need(n);s.assign(in,pos,n);pos+=n;}
+    template<class V,size_t I=0> static void emplaceIndex(V& v,size_t idx){
+        if constexpr(I<std::variant_size_v<V>){if(idx==I){v.template emplace<I>();return;}emplaceIndex<V,I+1>(v,idx);}
+        else throw std::runtime_error("Bad node in AST cache");
+    }
+    template<class N> void operator()(std::unique_ptr<N>& p){
+        size_t tag=varint();
+        if(!tag){p.reset();return;}
+        p=std::make_unique<N>();
+        emplaceIndex(p->node,tag-1);
+        if constexpr(std::is_same_v<N,Stmt>)p->line=(int)varint();
+        std::visit([&](auto& n){astIO(*this,n);},p->node);
+    }
+    template<class T> void operator()(std::vector<T>& v){
+        size_t n=varint();
+        if(n>in.size()-pos)throw std::runtime_error("Truncated AST cache");  // every element takes ≥1 byte
+        v.clear();v.resize(n);
+        for(auto&x:v)(*this)(x);
+    }
+    template<class X,class Y> void operator()(std::pair<X,Y>& p){(*this)(p.first);(*this)(p.second);}
+    template<class T,class U,class... R> void operator()(T& a,U& b,R&... rest){(*this)(a);(*this)(b,rest...);}
+};
+
+// Bump whenever an AST node or the encoding changes — old .irwc files are then ignored
+static const char     AST_CACHE_MAGIC[4]={'I','R','W','C'};
+static const uint32_t AST_CACHE_VERSION=10;
+
+static uint64_t sourceHash(const std::string& s){
+    uint64_t h=1469598103934665603ull;             // FNV-1a
+    for(unsigned char c:s){h^=c;h*=1099511628211ull;}
+    return h;
+}
+// foo.irw → foo.irwc, or <$IRONWOOD_CACHE_DIR>/foo-<path hash>.irwc
+static std::string astCachePath(const std::string& srcPath){
+    const char* dir=std::getenv("IRONWOOD_CACHE_DIR");
+    if(!dir||!*dir)return srcPath+"c";
+    std::error_code ec;
+    auto canon=std::filesystem::weakly_canonical(srcPath,ec);
+    std::ostringstream name;
+    name<<std::filesystem::path(srcPath).stem().string()<<"-"<<std::hex<<sourceHash(ec?srcPath:canon.string())<<".irwc";
+    return (std::filesystem::path(dir)/name.str()).string();
+}
+
+static StmtList parseSource(const std::string& source){
+    Parser parser(source);return parser.parse();
+}
+
+// Parse `source` (read from `path`), going through the .irwc cache when it is enabled
+static StmtList loadProgram(const std::string& path,const std::string& source){
+    if(!useAstCache)return parseSource(source);
+    uint64_t hash=sourceHash(source);
+    std::string cachePath=astCachePath(path);
+    {
+        std::ifstream f(cachePath,std::ios::binary);
+        if(f){
+            std::string data((std::istreambuf_iterator<char>(f)),{});
+            const size_t head=sizeof AST_CACHE_MAGIC+sizeof AST_CACHE_VERSION+sizeof hash;
+            uint32_t ver;uint64_t h;
+            if(data.size()>=head&&std::memcmp(data.data(),AST_CACHE_MAGIC,4)==0){
+                std::memcpy(&ver,data.data()+4,sizeof ver);
+                std::memcpy(&h,data.data()+8,sizeof h);
+                if(ver==AST_CACHE_VERSION&&h==hash){
+                    try{
+                        AstReader r(data,head);StmtList prog;r(prog);
+                        if(r.pos==data.size())return prog;
+                    }catch(std::exception&){}  // corrupt cache: fall through and rebuild it
+                }
+            }
+        }
+    }
+    StmtList prog=parseSource(source);
+    AstWriter w;
+    w.out.append(AST_CACHE_MAGIC,4);
+    w.out.append((const char*)&AST_CACHE_VERSION,sizeof AST_CACHE_VERSION);
+    w.out.append((const char*)&hash,sizeof hash);
+    w(prog);
+    // write-then-rename so a concurrent reader never sees half a file; failures just skip caching
+    std::error_code ec;
+    if(auto dir=std::filesystem::path(cachePath).parent_path();!dir.empty())std::filesystem::create_directories(dir,ec);
+    // the temp name is unique per process and thread: two ironwood processes (or two --serve
+    // workers) compiling the same script never write into each other's file
+    std::string tmp=cachePath+".tmp"+std::to_string((long long)getpid())+"-"+std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream f(tmp,std::ios::binary);
+        if(!f)return prog;
+        f<<w.out;
+        if(!f){f.close();std::filesystem::remove(tmp,ec);return prog;}
+    }
+    std::filesystem::rename(tmp,cachePath,ec);
+    if(ec)std::filesystem::remove(tmp,ec);
+    return prog;
+}
+
+// ============================================================
+//  VALUE POOL  (v3.2)
+//  Values, list buffers and dict nodes are small and made by
+//  the million. Each interpreter carves them out of 64 KB slabs
+//  in 16-byte size classes, reuses freed blocks from a free list
+//  per class, and gives every slab back at once when it goes
+//  away. Anything larger than the biggest class uses the heap.
+//  The pool also keeps the interpreter's heap account: its own
+//  blocks plus the text of string values, held to --max-heap.
 // ============================================================
 
 struct IronValue;
+struct TrackedValue;
+
+class ValuePool {
+public:
+    static constexpr size_t GRAIN=16,CLASSES=16,MAX_SMALL=GRAIN*CLASSES,SLAB=64*1024;
+    struct Stats { size_t allocs{0},frees{0},large{0},bytes{0},peakBytes{0},slabBytes{0},stringBytes{0}; };
+    ValuePool()=default;
+    ValuePool(const ValuePool&)=delete;
+    ValuePool& operator=(const ValuePool&)=delete;
+    ~ValuePool(){
+        tracked.clear();  // these point into the slabs
+        for(void* s:slabs)::operator delete(s);
+    }
+    void* allocate(size_t n){
+        stats.allocs++;
+        if(n>MAX_SMALL){stats.large++;grow(n);return ::operator new(n);}
+        size_t c=(n+GRAIN-1)/GRAIN-1,size=(c+1)*GRAIN;
+        grow(size);
+        if(Block* b=freeList[c]){freeList[c]=b->next;return b;}
+        if(cursor+size>slabEnd){  // the old slab's tail (under MAX_SMALL bytes) is left unused
+            cursor=(char*)::operator new(SLAB);slabEnd=cursor+SLAB;
+            slabs.push_back(cursor);stats.slabBytes+=SLAB;
+        }
+        void* p=cursor;cursor+=size;return p;
+    }
+    void deallocate(void* p,size_t n){
+        stats.frees++;
+        if(n>MAX_SMALL){shrink(n);::operator delete(p);return;}
+        size_t c=(n+GRAIN-1)/GRAIN-1;
+        shrink((c+1)*GRAIN);
+        auto* b=(Block*)p;b->next=freeList[c];freeList[c]=b;
+    }
+    // string values keep their text on the ordinary heap; it's counted here as they come and go
+    void addString(const std::string& s){size_t n=heapBytes(s);if(n){grow(n);stats.stringBytes+=n;}}
+    void dropString(const std::string& s){size_t n=std::min(heapBytes(s),stats.stringBytes);shrink(n);stats.stringBytes-=n;}
+    // v3.2: --max-heap. Going over throws a catchable error; until usage is well back under
+    // the limit the script gets a little headroom, so a catch block can still run.
+    size_t limit{0};
+    const Stats& counters() const {return stats;}
+    // the lists, dicts and functions made here and still alive, for the cycle collector
+    // (each one adds itself when it's made and takes itself out when it dies; see TrackedValue)
+    std::vector<TrackedValue*> tracked;
+    size_t trackedSince{0};  // made since the last collection
+private:
+    struct Block { Block* next; };
+    Block* freeList[CLASSES]{};
+    char* cursor{nullptr};char* slabEnd{nullptr};
+    std::vector<void*> slabs;
+    Stats stats;
+    bool overLimit{false};
+    void grow(size_t n){
+        if(limit&&stats.bytes+n>limit+(overLimit?headroom():0)){
+            overLimit=true;
+            throw std::runtime_error("Out of memory — the script is using more than "+std::to_string(limit/1024)+" KB (--max-heap)");
+        }
+        stats.bytes+=n;stats.peakBytes=std::max(stats.peakBytes,stats.bytes);
+    }
+    void shrink(size_t n){stats.bytes-=std::min(n,stats.bytes);if(stats.bytes+headroom()<limit)overLimit=false;}
+    size_t headroom() const {return std::max<size_t>(limit/16,256*1024);}
+    static size_t heapBytes(const std::string& s){  // 0 for short strings kept inside the object
+        const char* p=s.data();
+        return p>=(const char*)&s&&p<(const char*)(&s+1)?0:s.capacity()+1;
+    }
+};
+
+// the pool of the interpreter running on this thread (null outside one: plain heap)
+static thread_local ValuePool* currentPool=nullptr;
+// while it lives, values are made on the plain heap — for ones shared between interpreters
+struct PlainHeap { ValuePool* prev{currentPool}; PlainHeap(){currentPool=nullptr;} ~PlainHeap(){currentPool=prev;} };
+
+// Allocator for values and their containers. It remembers the pool it was made under,
+// so a block always goes back to the pool it came from.
+template<class T> struct PoolAlloc {
+    using value_type=T;
+    using propagate_on_container_copy_assignment=std::true_type;
+    using propagate_on_container_move_assignment=std::true_type;
+    using propagate_on_container_swap=std::true_type;
+    ValuePool* pool;
+    PoolAlloc():pool(currentPool){}
+    template<class U> PoolAlloc(const PoolAlloc<U>& o):pool(o.pool){}
+    T* allocate(size_t n){return (T*)(pool?pool->allocate(n*sizeof(T)): ::operator new(n*sizeof(T)));}
+    void deallocate(T* p,size_t n){if(pool)pool->deallocate(p,n*sizeof(T));else ::operator delete(p);}
+    template<class U> bool operator==(const PoolAlloc<U>& o) const {return pool==o.pool;}
+    template<class U> bool operator!=(const PoolAlloc<U>& o) const {return pool!=o.pool;}
+};
+template<class T,class... A> std::shared_ptr<T> makePooled(A&&... a){
+    return std::allocate_shared<T>(PoolAlloc<T>(),std::forward<A>(a)...);
+}
+
+// ============================================================
+//  VALUES
+// ============================================================
+
 using ValuePtr   = std::shared_ptr<IronValue>;
-using IronArray  = std::vector<ValuePtr>;
-using IronObject = std::unordered_map<std::string,ValuePtr>;
-struct IronFunc  { std::vector<std::string> params; const StmtList* body; struct Env* closure; };
+using IronArray  = std::vector<ValuePtr,PoolAlloc<ValuePtr>>;
+using IronObject = std::unordered_map<std::string,ValuePtr,std::hash<std::string>,std::equal_to<std::string>,
+                                      PoolAlloc<std::pair<const std::string,ValuePtr>>>;
+struct IronFunc  { std::vector<std::string> params; const StmtList* body; struct Env* closure;
+                   struct Env* home{nullptr}; };  // v3.2: the call frame the closure lives in (null at top level)
 using NativeFunc = std::function<ValuePtr(std::vector<ValuePtr>)>;
 
 struct IronValue {
@@ -760,14 +1341,19 @@ struct IronValue {
                  std::shared_ptr<IronArray>,std::shared_ptr<IronObject>,
                  IronFunc,NativeFunc> data;
 
-    static ValuePtr makeNull()             {auto v=std::make_shared<IronValue>();v->data=nullptr;return v;}
-    static ValuePtr makeBool(bool b)       {auto v=std::make_shared<IronValue>();v->data=b;return v;}
-    static ValuePtr makeNum(double d)      {auto v=std::make_shared<IronValue>();v->data=d;return v;}
-    static ValuePtr makeStr(std::string s) {auto v=std::make_shared<IronValue>();v->data=std::move(s);return v;}
-    static ValuePtr makeArr(std::shared_ptr<IronArray> a){auto v=std::make_shared<IronValue>();v->data=a;return v;}
-    static ValuePtr makeObj(std::shared_ptr<IronObject> o){auto v=std::make_shared<IronValue>();v->data=o;return v;}
-    static ValuePtr makeFunc(IronFunc f)   {auto v=std::make_shared<IronValue>();v->data=f;return v;}
-    static ValuePtr makeNative(NativeFunc f){auto v=std::make_shared<IronValue>();v->data=f;return v;}
+    static ValuePtr makeNull()             {auto v=makePooled<IronValue>();v->data=nullptr;return v;}
+    static ValuePtr makeBool(bool b)       {auto v=makePooled<IronValue>();v->data=b;return v;}
+    static ValuePtr makeNum(double d)      {auto v=makePooled<IronValue>();v->data=d;return v;}
+    static ValuePtr makeStr(std::string s) {auto v=makePooled<IronValue>();if(currentPool)currentPool->addString(s);v->data=std::move(s);return v;}
+    static ValuePtr makeArr(std::shared_ptr<IronArray> a){auto v=makeTracked();v->data=a;return v;}
+    static ValuePtr makeObj(std::shared_ptr<IronObject> o){auto v=makeTracked();v->data=o;return v;}
+    static ValuePtr makeFunc(IronFunc f)   {auto v=makeTracked();v->data=f;return v;}
+    static ValuePtr makeNative(NativeFunc f){auto v=makePooled<IronValue>();v->data=f;return v;}
+    ~IronValue(){if(currentPool)if(auto*s=std::get_if<std::string>(&data))currentPool->dropString(*s);}
+
+    // v3.2: lists, dicts and functions are the values that can end up in a reference cycle;
+    // in a pool they're made as TrackedValues so the interpreter's cycle collector can find them.
+    static ValuePtr makeTracked();
 
     bool isTruthy() const {
         if(std::get_if<std::nullptr_t>(&data))return false;
@@ -807,13 +1393,403 @@ struct IronValue {
     }
 };
 
+// v3.2: a value in its pool's collector registry from the moment it's made until it dies. The
+// registry holds plain pointers, not weak_ptrs: a weak_ptr would keep the block the value and
+// its control block share (allocate_shared) allocated, and counted, until the next collection.
+struct TrackedValue : IronValue, std::enable_shared_from_this<TrackedValue> {
+    ValuePool* pool;size_t slot;
+    explicit TrackedValue(ValuePool* p):pool(p),slot(p->tracked.size()){p->tracked.push_back(this);p->trackedSince++;}
+    ~TrackedValue(){
+        auto& t=pool->tracked;  // swap the last entry into this one's place
+        t[slot]=t.back();t[slot]->slot=slot;t.pop_back();
+    }
+    TrackedValue(const TrackedValue&)=delete;
+    TrackedValue& operator=(const TrackedValue&)=delete;
+};
+inline ValuePtr IronValue::makeTracked(){
+    if(!currentPool)return makePooled<IronValue>();  // plain heap: shared, never collected
+    return std::allocate_shared<TrackedValue>(PoolAlloc<TrackedValue>(),currentPool);
+}
+
+// ---- v3.2: number-list operations ----
+// Lists hold boxed values, so the time goes into reaching each number and boxing the results,
+// not into the arithmetic: each loop below reads the items where they are, in one pass, and
+// boxes results straight into the new list.
+
+// item i as a number, or an error naming it
+static double numberAt(const IronArray& list,size_t i,const char* what){
+    if(auto*d=std::get_if<double>(&list[i]->data))return *d;
+    throw std::runtime_error(std::string("'")+what+" of' needs numbers — item "+std::to_string(i+1)+" is "+list[i]->toString()+".");
+}
+
+// sum / min / max / average of a list; null for min, max and average of an empty one
+static ValuePtr reduceNumbers(const std::string& op,const IronArray& list){
+    const char* what=op.c_str();size_t n=list.size();
+    if(op=="min"||op=="max"){
+        if(!n)return IronValue::makeNull();
+        bool min=op=="min";
+        double best=numberAt(list,0,what);
+        for(size_t i=1;i<n;i++){double x=numberAt(list,i,what);best=min?std::min(best,x):std::max(best,x);}
+        return IronValue::makeNum(best);
+    }
+    double s0=0,s1=0,s2=0,s3=0;  // four running sums so consecutive adds don't wait on each other
+    size_t i=0;
+    for(;i+4<=n;i+=4){
+        s0+=numberAt(list,i,what);s1+=numberAt(list,i+1,what);
+        s2+=numberAt(list,i+2,what);s3+=numberAt(list,i+3,what);
+    }
+    double s=(s0+s1)+(s2+s3);
+    for(;i<n;i++)s+=numberAt(list,i,what);
+    if(op=="sum")return IronValue::makeNum(s);
+    return n?IronValue::makeNum(s/n):IronValue::makeNull();
+}
+
+static bool allNumbers(const IronArray& list){
+    for(auto&v:list)if(!std::get_if<double>(&v->data))return false;
+    return true;
+}
+
+// list + list, list - list, list * list (same length), list * n, n * list, list / n;
+// null when a list holds something other than numbers (the operands are then joined as text)
+static ValuePtr listArithmetic(const std::string& op,const ValuePtr& left,const ValuePtr& right){
+    auto*la=std::get_if<std::shared_ptr<IronArray>>(&left->data);
+    auto*ra=std::get_if<std::shared_ptr<IronArray>>(&right->data);
+    auto*ln=std::get_if<double>(&left->data);auto*rn=std::get_if<double>(&right->data);
+    auto zip=[&](auto f)->ValuePtr{
+        auto& a=**la;auto& b=**ra;
+        auto arr=makePooled<IronArray>();arr->reserve(a.size());
+        for(size_t i=0;i<a.size();i++){
+            auto*x=std::get_if<double>(&a[i]->data);auto*y=std::get_if<double>(&b[i]->data);
+            if(!x||!y)return nullptr;
+            arr->push_back(IronValue::makeNum(f(*x,*y)));
+        }
+        return IronValue::makeArr(arr);
+    };
+    auto each=[&](const IronArray& a,auto f)->ValuePtr{
+        auto arr=makePooled<IronArray>();arr->reserve(a.size());
+        for(auto&v:a){
+            auto*x=std::get_if<double>(&v->data);
+            if(!x)return nullptr;
+            arr->push_back(IronValue::makeNum(f(*x)));
+        }
+        return IronValue::makeArr(arr);
+    };
+    if(la&&ra&&(op=="+"||op=="-"||op=="*")){
+        if((*la)->size()!=(*ra)->size()){
+            if(!allNumbers(**la)||!allNumbers(**ra))return nullptr;
+            throw std::runtime_error("Can't "+std::string(op=="+"?"add":op=="-"?"subtract":"multiply")+" lists of different lengths ("+
+                                     std::to_string((*la)->size())+" and "+std::to_string((*ra)->size())+").");
+        }
+        if(op=="+")return zip(std::plus<double>());
+        if(op=="-")return zip(std::minus<double>());
+        return zip(std::multiplies<double>());
+    }
+    if((la&&rn&&(op=="*"||op=="/"))||(ln&&ra&&op=="*")){
+        double k=la?*rn:*ln;
+        auto& list=la?**la:**ra;
+        if(op=="/"){
+            if(!allNumbers(list))return nullptr;
+            if(k==0)throw std::runtime_error("Can't divide by zero!");
+            return each(list,[k](double x){return x/k;});
+        }
+        return each(list,[k](double x){return x*k;});
+    }
+    return nullptr;
+}
+
+// Arithmetic / comparison on two evaluated operands ('and'/'or' short-circuit, so they're not here)
+static ValuePtr binaryOp(const std::string& op,const ValuePtr& left,const ValuePtr& right){
+    auto*ln=std::get_if<double>(&left->data);auto*rn=std::get_if<double>(&right->data);
+    if(!(ln&&rn)&&(std::get_if<std::shared_ptr<IronArray>>(&left->data)||std::get_if<std::shared_ptr<IronArray>>(&right->data)))
+        if(auto v=listArithmetic(op,left,right))return v;
+    if(op=="+"){if(ln&&rn)return IronValue::makeNum(*ln+*rn);return IronValue::makeStr(left->toString()+right->toString());}
+    if(ln&&rn){
+        if(op=="-")return IronValue::makeNum(*ln-*rn);
+        if(op=="*")return IronValue::makeNum(*ln**rn);
+        if(op=="/"){if(*rn==0)throw std::runtime_error("Can't divide by zero!");return IronValue::makeNum(*ln/ *rn);}
+        if(op=="%")return IronValue::makeNum(std::fmod(*ln,*rn));
+        if(op=="<")return IronValue::makeBool(*ln<*rn);
+        if(op==">")return IronValue::makeBool(*ln>*rn);
+        if(op=="<=")return IronValue::makeBool(*ln<=*rn);
+        if(op==">=")return IronValue::makeBool(*ln>=*rn);
+    }
+    if(op=="==")return IronValue::makeBool(left->toString()==right->toString());
+    if(op=="!=")return IronValue::makeBool(left->toString()!=right->toString());
+    return IronValue::makeNull();
+}
+
+static ValuePtr unaryOp(const std::string& op,const ValuePtr& v){
+    if(op=="-"&&std::get_if<double>(&v->data))return IronValue::makeNum(-std::get<double>(v->data));
+    if(op=="not")return IronValue::makeBool(!v->isTruthy());
+    return IronValue::makeNull();
+}
+
+// ============================================================
+//  OPTIMIZER  (v3.2)
+//  Runs once between parsing and running (unless -O0). Folds
+//  operators, ternaries and 'and'/'or' whose operands are
+//  literals, drops if/while bodies that can never run, and
+//  prebuilds literal-only lists and dicts so evaluating one is
+//  a copy. It walks the tree through the same astIO() field
+//  lists the AST cache uses.
+// ============================================================
+
+// A fresh copy of a prebuilt constant: lists and dicts are mutable, so they are copied
+// (recursively, into the running interpreter's pool); scalars are never changed in place,
+// so they can be shared.
+static ValuePtr cloneConstant(const ValuePtr& v){
+    if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&v->data)){
+        auto arr=makePooled<IronArray>(**ap,IronArray::allocator_type());
+        for(auto&x:*arr)x=cloneConstant(x);
+        return IronValue::makeArr(arr);
+    }
+    if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&v->data)){
+        auto obj=makePooled<IronObject>(**op,IronObject::allocator_type());  // a copy keeps the literal's key order
+        for(auto&kv:*obj)kv.second=cloneConstant(kv.second);
+        return IronValue::makeObj(obj);
+    }
+    return v;
+}
+
+struct AstOptimizer {
+    // the value of a literal, or null if the expression isn't one
+    static ValuePtr constantOf(const ExprPtr& e){
+        if(!e)return nullptr;
+        if(auto*n=std::get_if<NumberLit>(&e->node))return IronValue::makeNum(n->value);
+        if(auto*b=std::get_if<BoolLit>(&e->node))return IronValue::makeBool(b->value);
+        if(std::holds_alternative<NullLit>(e->node))return IronValue::makeNull();
+        // strings are interpolated when evaluated, so only brace-free ones are constant
+        if(auto*s=std::get_if<StringLit>(&e->node))return s->value.find('{')==std::string::npos?IronValue::makeStr(s->value):nullptr;
+        if(auto*a=std::get_if<ArrayLit>(&e->node))return a->constant;
+        if(auto*o=std::get_if<ObjectLit>(&e->node))return o->constant;
+        return nullptr;
+    }
+    // turn a folded scalar back into a literal node (false if it can't be one)
+    static bool replaceWith(ExprPtr& e,const ValuePtr& v){
+        auto lit=std::make_unique<Expr>();
+        if(auto*n=std::get_if<double>(&v->data))lit->node=NumberLit{*n};
+        else if(auto*b=std::get_if<bool>(&v->data))lit->node=BoolLit{*b};
+        else if(std::get_if<std::nullptr_t>(&v->data))lit->node=NullLit{};
+        else if(auto*s=std::get_if<std::string>(&v->data)){
+            if(s->find('{')!=std::string::npos)return false;
+            lit->node=StringLit{*s};
+        }
+        else return false;
+        e=std::move(lit);return true;
+    }
+    void fold(ExprPtr& e){
+        if(auto*b=std::get_if<BinExpr>(&e->node)){
+            auto l=constantOf(b->left);if(!l)return;
+            if(b->op=="and"){ExprPtr keep=std::move(l->isTruthy()?b->right:b->left);e=std::move(keep);return;}
+            if(b->op=="or") {ExprPtr keep=std::move(l->isTruthy()?b->left:b->right);e=std::move(keep);return;}
+            auto r=constantOf(b->right);if(!r)return;
+            if(std::get_if<std::shared_ptr<IronArray>>(&l->data)||std::get_if<std::shared_ptr<IronObject>>(&l->data)||
+               std::get_if<std::shared_ptr<IronArray>>(&r->data)||std::get_if<std::shared_ptr<IronObject>>(&r->data))return;
+            try{replaceWith(e,binaryOp(b->op,l,r));}catch(std::exception&){}  // e.g. 1/0 stays a runtime error
+        }
+        else if(auto*u=std::get_if<UnaryExpr>(&e->node)){
+            if(auto v=constantOf(u->operand))replaceWith(e,unaryOp(u->op,v));
+        }
+        else if(auto*t=std::get_if<TernaryExpr>(&e->node)){
+            auto c=constantOf(t->cond);if(!c)return;
+            ExprPtr keep=std::move(c->isTruthy()?t->thenE:t->elseE);e=std::move(keep);
+        }
+        else if(auto*a=std::get_if<ArrayLit>(&e->node)){
+            auto arr=makePooled<IronArray>();
+            for(auto&x:a->elems){auto v=constantOf(x);if(!v)return;arr->push_back(v);}
+            a->constant=IronValue::makeArr(arr);
+        }
+        else if(auto*o=std::get_if<ObjectLit>(&e->node)){
+            auto obj=makePooled<IronObject>();
+            for(auto&[k,x]:o->pairs){auto v=constantOf(x);if(!v)return;(*obj)[k]=v;}
+            o->constant=IronValue::makeObj(obj);
+        }
+    }
+    // returns false when the statement can never do anything and should be dropped
+    bool fold(StmtPtr& s){
+        if(auto*i=std::get_if<IfStmt>(&s->node)){
+            auto c=constantOf(i->cond);if(!c)return true;
+            if(!c->isTruthy()){
+                if(i->elseBody.empty())return false;
+                i->thenBody=std::move(i->elseBody);
+            }
+            i->elseBody.clear();
+            i->cond=std::make_unique<Expr>();i->cond->node=BoolLit{true};  // keeps its own scope
+        }
+        else if(auto*w=std::get_if<WhileStmt>(&s->node)){
+            auto c=constantOf(w->cond);
+            if(c&&!c->isTruthy())return false;
+        }
+        return true;
+    }
+
+    void operator()(double&){}
+    void operator()(bool&){}
+    void operator()(std::string&){}
+    void operator()(ExprPtr& e){
+        if(!e)return;
+        std::visit([&](auto& n){astIO(*this,n);},e->node);  // children first, so folds cascade
+        fold(e);
+    }
+    void operator()(StmtList& list){
+        for(auto&s:list)if(s)std::visit([&](auto& n){astIO(*this,n);},s->node);
+        list.erase(std::remove_if(list.begin(),list.end(),[&](StmtPtr& s){return !s||!fold(s);}),list.end());
+    }
+    template<class T> void operator()(std::vector<T>& v){for(auto&x:v)(*this)(x);}
+    template<class X,class Y> void operator()(std::pair<X,Y>& p){(*this)(p.first);(*this)(p.second);}
+    template<class T,class U,class... R> void operator()(T& a,U& b,R&... rest){(*this)(a);(*this)(b,rest...);}
+};
+
+static void optimizeProgram(StmtList& program){
+    if(optLevel<1)return;
+    AstOptimizer opt;opt(program);
+}
+
+// v3.2: calls fn(stmt) for every statement in a program, nested ones included
+// (blocks, function and method bodies, lambdas)
+template<class F> struct StmtWalker {
+    F& fn;
+    void operator()(double&){}
+    void operator()(bool&){}
+    void operator()(std::string&){}
+    void operator()(ExprPtr& e){if(e)std::visit([&](auto& n){astIO(*this,n);},e->node);}
+    void operator()(StmtList& list){for(auto&s:list)if(s){fn(*s);std::visit([&](auto& n){astIO(*this,n);},s->node);}}
+    template<class T> void operator()(std::vector<T>& v){for(auto&x:v)(*this)(x);}
+    template<class X,class Y> void operator()(std::pair<X,Y>& p){(*this)(p.first);(*this)(p.second);}
+    template<class T,class U,class... R> void operator()(T& a,U& b,R&... rest){(*this)(a);(*this)(b,rest...);}
+};
+template<class F> static void forEachStmt(StmtList& program,F fn){StmtWalker<F> walk{fn};walk(program);}
+
+static bool isModulePath(const std::string& path){return path.size()>4&&path.compare(path.size()-4,4,".irw")==0;}
+
+// v3.2: the .irw modules a program can 'get', wherever the statement sits
+static std::vector<std::string> moduleImports(StmtList& program){
+    std::vector<std::string> paths;
+    forEachStmt(program,[&](Stmt& s){if(auto*g=std::get_if<GetStmt>(&s.node);g&&isModulePath(g->path))paths.push_back(g->path);});
+    return paths;
+}
+
+// v3.2: modules parsed and optimized once per process, and shared read-only by every interpreter
+// in it (embedded engines, --serve workers) while the file is unchanged. Different modules parse
+// at the same time; a second thread wanting a module that is being parsed waits for it.
+struct ParsedModule { std::filesystem::file_time_type mtime; std::shared_ptr<const StmtList> program; std::vector<std::string> imports; };
+static std::mutex parsedModulesLock;
+static std::condition_variable moduleParsed;
+static std::unordered_map<std::string,ParsedModule> parsedModules;
+static std::unordered_set<std::string> parsingModules;  // keys some thread is parsing (one writer per .irwc)
+static ParsedModule parseModule(const std::string& key,const std::string& path,
+                                std::filesystem::file_time_type mtime,bool known){
+    auto parse=[&]{
+        std::ifstream f(path);
+        if(!f)throw std::runtime_error("Can't open module: "+path);
+        std::string src((std::istreambuf_iterator<char>(f)),{});
+        PlainHeap plain;  // prebuilt constants outlive this interpreter
+        auto program=std::make_shared<StmtList>(loadProgram(path,src));
+        optimizeProgram(*program);
+        auto imports=moduleImports(*program);
+        return ParsedModule{mtime,std::move(program),std::move(imports)};
+    };
+    if(!known)return parse();
+    std::unique_lock<std::mutex> lock(parsedModulesLock);
+    for(;;){
+        auto it=parsedModules.find(key);
+        if(it!=parsedModules.end()&&it->second.mtime==mtime)return it->second;
+        if(!parsingModules.count(key))break;
+        moduleParsed.wait(lock);
+    }
+    parsingModules.insert(key);
+    lock.unlock();
+    ParsedModule mod;
+    try{mod=parse();}
+    catch(...){lock.lock();parsingModules.erase(key);moduleParsed.notify_all();throw;}
+    lock.lock();
+    parsingModules.erase(key);
+    parsedModules[key]=mod;
+    moduleParsed.notify_all();
+    return mod;
+}
+
+// v3.2: before a program runs, every module it can reach through 'get' is parsed on a pool of
+// threads, so each 'get' finds its AST in parsedModules. Errors are left for the 'get' itself
+// to report (a module that is never reached shouldn't fail the program).
+static void prefetchModules(StmtList& program){
+    auto locate=[](const std::string& path,std::string& key,std::filesystem::file_time_type& mtime){
+        std::error_code ec;
+        key=std::filesystem::weakly_canonical(path,ec).string();
+        if(ec)key=path;
+        mtime=std::filesystem::last_write_time(path,ec);
+        return !ec;
+    };
+    // walk what's already parsed on this thread; only modules that aren't go to the pool
+    std::deque<std::string> todo;
+    std::unordered_set<std::string> seen;
+    std::vector<std::string> walk;
+    for(auto& p:moduleImports(program))if(seen.insert(p).second)walk.push_back(p);
+    while(!walk.empty()){
+        std::string path=std::move(walk.back());walk.pop_back();
+        std::string key;std::filesystem::file_time_type mtime;
+        if(!locate(path,key,mtime))continue;  // missing: the 'get' reports it
+        std::vector<std::string> found;
+        {
+            std::lock_guard<std::mutex> lock(parsedModulesLock);
+            auto it=parsedModules.find(key);
+            if(it==parsedModules.end()||it->second.mtime!=mtime){todo.push_back(std::move(path));continue;}
+            found=it->second.imports;
+        }
+        for(auto& p:found)if(seen.insert(p).second)walk.push_back(p);
+    }
+    if(todo.empty())return;
+    // The pool starts with a thread per module known to need parsing and grows, up to one per core,
+    // as parsed modules turn up more imports than there are idle threads to take them. (This thread
+    // is one of them.)
+    size_t cores=std::max(1u,std::thread::hardware_concurrency());
+    std::mutex m;std::condition_variable cv;size_t busy=0,idle=0;
+    std::vector<std::thread> pool;
+    std::function<void()> work=[&]{
+        std::unique_lock<std::mutex> lock(m);
+        for(;;){
+            cv.wait(lock,[&]{return !todo.empty()||busy==0;});
+            if(todo.empty())return;
+            std::string path=std::move(todo.front());todo.pop_front();busy++;idle--;
+            lock.unlock();
+            std::vector<std::string> found;
+            try{
+                std::string key;std::filesystem::file_time_type mtime;
+                if(locate(path,key,mtime))found=parseModule(key,path,mtime,true).imports;
+            }catch(std::exception&){}
+            lock.lock();busy--;idle++;
+            for(auto& p:found)if(seen.insert(p).second)todo.push_back(p);
+            // under the lock, so once busy reaches 0 nobody adds threads and the joins below are safe
+            while(pool.size()+1<cores&&todo.size()>idle){idle++;pool.emplace_back(work);}
+            cv.notify_all();
+        }
+    };
+    idle=std::min(todo.size(),cores);
+    for(size_t i=1;i<idle;i++)pool.emplace_back(work);
+    work();
+    for(auto& t:pool)t.join();
+}
+
 // ============================================================
 //  ENVIRONMENT
 // ============================================================
 
 struct Env {
-    std::unordered_map<std::string,ValuePtr> vars;
+    IronObject vars;  // (v3.2: a pooled map, like a dict's)
     Env* parent{nullptr};
+    // v3.2: call frames live in a reusable pool. A frame a closure can see is 'captured' (a tail
+    // call mustn't recycle it); one whose closures outlive the call is 'pinned' and never reused.
+    bool frame{false},captured{false},pinned{false};
+    std::vector<std::weak_ptr<IronValue>> closures;  // functions made in this frame
+    Env* outer{nullptr};  // the frame the running function's closure lives in
+    void capture(const ValuePtr& fn){
+        bool noted=false;
+        for(Env* e=this;e;e=e->parent){
+            e->captured=true;
+            if(e->frame&&!noted){e->closures.push_back(fn);std::get<IronFunc>(fn->data).home=e;noted=true;}
+        }
+    }
+    void pin(){for(Env* e=this;e&&!e->pinned;e=e->parent)e->pinned=e->captured=true;}
     ValuePtr get(const std::string& n) const {
         auto it=vars.find(n);if(it!=vars.end())return it->second;
         if(parent)return parent->get(n);
@@ -831,10 +1807,50 @@ struct Env {
 //  CONTROL FLOW SIGNALS
 // ============================================================
 
-struct ReturnSignal   { ValuePtr value; };
-struct BreakSignal    {};
-struct ContinueSignal {};
+// v3.2: break/continue/return travel back up as a status instead of C++ exceptions;
+// the returned value (or the pending tail call) waits on the Interpreter.
+enum class Flow { NORMAL, BREAK, CONTINUE, RETURN, TAIL_CALL };
 struct ThrowSignal    { std::string message; };  // v2.0 user throws
+// v3.2: --max-steps / --timeout ran out. Not a ThrowSignal: 'try' can't catch it.
+struct LimitSignal    { std::string message; };
+
+// v3.2: Ironwood calls nest at most this deep (--max-depth); deeper is a catchable
+// "Stack overflow" error. The interpreter's native stack is sized from it.
+static size_t maxCallDepth=10000;
+static const size_t NATIVE_STACK_PER_CALL=8*1024;
+static const size_t MAX_CALL_DEPTH_LIMIT=10000000;
+
+// v3.2: the cycle collector runs once this many lists/dicts/functions (or as many as were
+// alive after the last collection, if more) have been made since it last ran.
+static const size_t GC_MIN_THRESHOLD=10000;
+static size_t maxHeapBytes=0;   // --max-heap (0 = no limit)
+
+// v3.2: --max-steps / --timeout. A step is one loop iteration or one call; the clock is
+// read once every STEP_CLOCK_SAMPLE steps.
+static uint64_t maxSteps=0;
+static double timeoutSeconds=0;
+static const uint64_t STEP_CLOCK_SAMPLE=256;
+
+// v3.2: --timeout as a point in time, for the waits that block between steps (a child's pipes,
+// fetch sockets, the async reactor). They wait at most until it, then clean up and throw
+// TimedOut; the interpreter turns that into the --timeout error (Interpreter::blocking).
+struct Deadline {
+    bool set{false};
+    std::chrono::steady_clock::time_point at;
+    bool passed() const {return set&&std::chrono::steady_clock::now()>=at;}
+    // a poll()/epoll_wait() timeout: -1 without a deadline, otherwise the milliseconds left, rounded up
+    int waitMs() const {
+        if(!set)return -1;
+        auto left=std::chrono::duration_cast<std::chrono::milliseconds>(at-std::chrono::steady_clock::now()).count()+1;
+        return (int)std::max<long long>(0,std::min<long long>(left,std::numeric_limits<int>::max()));
+    }
+};
+struct TimedOut {};
+
+// v3.2: set by main() when this process is the ironwood command running one script. Only then
+// may 'serve ... workers: N' fork: an embedding host or a --serve worker has other threads, and
+// a child forked while one of them holds a lock (module or script cache) would wait on it forever.
+static bool ownsProcess=false;
 
 // ============================================================
 //  CLASS REGISTRY  (v2.0)
@@ -847,15 +1863,305 @@ struct ClassDef {
     Env* definitionEnv{nullptr};
 };
 
+// ============================================================
+//  CSV  (v3.2)
+//  RFC 4180 records: fields split on the separator, "quoted"
+//  fields may hold separators, newlines and "" for a quote.
+//  Unquoted fields that read as numbers become numbers (except
+//  ones with leading zeros, like zip codes); everything else
+//  stays text. The scan for the next separator/newline looks at
+//  16 bytes at a time with SSE2.
+// ============================================================
+
+class CsvReader {
+public:
+    struct Field { std::string text; bool quoted{false}; };
+    explicit CsvReader(char sep):sep(sep){}
+    // Reads one record from [p,end) into row and returns the bytes it used. Returns 0 when the
+    // record might continue past end — call again with more input, or with eof=true at the end.
+    size_t next(const char* p,const char* end,bool eof,std::vector<Field>& row) const {
+        row.clear();
+        const char* s=p;
+        if(s==end)return 0;
+        for(;;){
+            row.emplace_back();
+            Field& f=row.back();
+            if(s<end&&*s=='"'){
+                f.quoted=true;s++;
+                for(;;){
+                    auto*q=(const char*)std::memchr(s,'"',end-s);
+                    if(!q){if(!eof)return 0;f.text.append(s,end);s=end;break;}  // unterminated: keep the rest
+                    f.text.append(s,q);s=q+1;
+                    if(s==end&&!eof)return 0;          // can't tell "" from a closing quote yet
+                    if(s<end&&*s=='"'){f.text+='"';s++;continue;}
+                    break;
+                }
+                const char* t=scan(s,end);f.text.append(s,t);s=t;  // stray text after the quote is kept
+            }
+            else{const char* t=scan(s,end);f.text.assign(s,t);s=t;}
+            if(s==end){if(!eof)return 0;return s-p;}
+            if(*s==sep){s++;if(s==end&&!eof)return 0;continue;}
+            if(*s=='\r'){s++;if(s==end&&!eof)return 0;if(s<end&&*s=='\n')s++;}
+            else s++;  // '\n'
+            return s-p;
+        }
+    }
+    static bool blank(const std::vector<Field>& row){return row.size()==1&&row[0].text.empty()&&!row[0].quoted;}
+private:
+    char sep;
+    // first separator, '\n' or '\r' at or after p
+    const char* scan(const char* p,const char* end) const {
+#ifdef __SSE2__
+        const __m128i vs=_mm_set1_epi8(sep),vn=_mm_set1_epi8('\n'),vr=_mm_set1_epi8('\r');
+        for(;end-p>=16;p+=16){
+            __m128i c=_mm_loadu_si128((const __m128i*)p);
+            int m=_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(c,vs),_mm_cmpeq_epi8(c,vn)),_mm_cmpeq_epi8(c,vr)));
+            if(m)return p+__builtin_ctz(m);
+        }
+#endif
+        while(p<end&&*p!=sep&&*p!='\n'&&*p!='\r')p++;
+        return p;
+    }
+};
+
+// does an unquoted field read as a number? (digits, optional sign / fraction / exponent)
+static bool csvNumeric(const std::string& s){
+    size_t i=0,n=s.size();
+    if(i<n&&(s[i]=='+'||s[i]=='-'))i++;
+    size_t start=i;while(i<n&&std::isdigit((unsigned char)s[i]))i++;
+    size_t whole=i-start,frac=0;
+    if(whole>1&&s[start]=='0')return false;  // 007, 02134: an identifier, not a number
+    if(i<n&&s[i]=='.'){i++;while(i<n&&std::isdigit((unsigned char)s[i])){i++;frac++;}}
+    if(whole+frac==0)return false;
+    if(i<n&&(s[i]=='e'||s[i]=='E')){
+        i++;if(i<n&&(s[i]=='+'||s[i]=='-'))i++;
+        size_t exp=0;while(i<n&&std::isdigit((unsigned char)s[i])){i++;exp++;}
+        if(!exp)return false;
+    }
+    return i==n;
+}
+
+static ValuePtr csvValue(CsvReader::Field& f){
+    if(!f.quoted&&csvNumeric(f.text))return IronValue::makeNum(std::strtod(f.text.c_str(),nullptr));
+    return IronValue::makeStr(std::move(f.text));
+}
+
+// a row as a list, or (given the header) as a dict keyed by column name
+static ValuePtr csvRow(std::vector<CsvReader::Field>& row,const std::vector<std::string>* header){
+    if(!header){
+        auto arr=makePooled<IronArray>();arr->reserve(row.size());
+        for(auto&f:row)arr->push_back(csvValue(f));
+        return IronValue::makeArr(arr);
+    }
+    auto obj=makePooled<IronObject>();
+    for(size_t i=0;i<std::max(row.size(),header->size());i++){
+        std::string key=i<header->size()?(*header)[i]:"column"+std::to_string(i+1);
+        (*obj)[key]=i<row.size()?csvValue(row[i]):IronValue::makeNull();
+    }
+    return IronValue::makeObj(obj);
+}
+
+// Feeds every record of a CSV string or file to onRow (which returns false to stop early).
+// Files are read a megabyte at a time, so a file of any size streams in bounded memory.
+static void readCsv(const std::string& src,bool file,char sep,bool header,
+                    const std::function<bool(ValuePtr)>& onRow){
+    CsvReader reader(sep);
+    std::vector<CsvReader::Field> row;
+    std::vector<std::string> names;bool haveNames=!header;
+    auto emit=[&]()->bool{
+        if(CsvReader::blank(row))return true;
+        if(!haveNames){for(auto&f:row)names.push_back(std::move(f.text));haveNames=true;return true;}
+        return onRow(csvRow(row,header?&names:nullptr));
+    };
+    if(!file){
+        const char* p=src.data(),*end=p+src.size();
+        while(p<end){p+=reader.next(p,end,true,row);if(!emit())return;}
+        return;
+    }
+    std::ifstream in(src,std::ios::binary);
+    if(!in)throw ThrowSignal{"Can't open file: "+src};
+    const size_t CHUNK=1<<20;
+    std::string buf;size_t pos=0;bool eof=false;
+    while(true){
+        if(!eof){
+            if(pos>0){buf.erase(0,pos);pos=0;}
+            size_t have=buf.size();buf.resize(have+CHUNK);
+            in.read(&buf[have],CHUNK);
+            buf.resize(have+in.gcount());
+            eof=in.gcount()==0;
+        }
+        for(;;){
+            size_t used=reader.next(buf.data()+pos,buf.data()+buf.size(),eof,row);
+            if(!used)break;
+            pos+=used;
+            if(!emit())return;
+        }
+        if(eof)return;
+    }
+}
+
+// one field of 'csv of' output: quoted when it holds a separator, quote or line break — or when
+// it's text that would otherwise read back as a number
+static void csvField(std::string& out,const ValuePtr& v){
+    if(std::get_if<std::nullptr_t>(&v->data))return;
+    auto*str=std::get_if<std::string>(&v->data);
+    std::string t=v->toString();
+    if(t.find_first_of(",\"\r\n")==std::string::npos&&!(str&&csvNumeric(t))){out+=t;return;}
+    out+='"';
+    for(char c:t){if(c=='"')out+='"';out+=c;}
+    out+='"';
+}
+
+// The columns 'csv of' writes for dict rows: the ones given with {columns: [...]}, in that
+// order, or else the first row's keys sorted by name (dicts don't keep their key order).
+static std::vector<std::string> csvColumns(const IronObject& first,const IronArray* columns){
+    std::vector<std::string> cols;
+    if(columns){for(auto&c:*columns)cols.push_back(c->toString());return cols;}
+    for(auto&[k,v]:first)if(k!="__class__")cols.push_back(k);
+    std::sort(cols.begin(),cols.end());
+    return cols;
+}
+
+static std::string csvText(const ValuePtr& rows,const IronArray* columns){
+    auto*ap=std::get_if<std::shared_ptr<IronArray>>(&rows->data);
+    if(!ap)throw std::runtime_error("'csv of' needs a list of rows.");
+    std::string out;
+    std::vector<std::string> header;  // rows that are dicts: columns come from the first one
+    for(auto&row:**ap){
+        if(auto*r=std::get_if<std::shared_ptr<IronArray>>(&row->data)){
+            for(size_t i=0;i<(*r)->size();i++){if(i)out+=',';csvField(out,(**r)[i]);}
+        }
+        else if(auto*o=std::get_if<std::shared_ptr<IronObject>>(&row->data)){
+            if(header.empty()){
+                header=csvColumns(**o,columns);
+                for(size_t i=0;i<header.size();i++){if(i)out+=',';csvField(out,IronValue::makeStr(header[i]));}
+                out+='\n';
+            }
+            for(size_t i=0;i<header.size();i++){
+                if(i)out+=',';
+                auto it=(*o)->find(header[i]);
+                if(it!=(*o)->end())csvField(out,it->second);
+            }
+        }
+        else csvField(out,row);
+        out+='\n';
+    }
+    return out;
+}
+
+// ============================================================
+//  SORTING  (v3.2)
+//  'sort' decorates first: each key becomes a column of numbers
+//  or strings, computed once per item. The ordering is the one
+//  sort has always used — numbers by value, anything else by its
+//  text, stable — applied column by column. Big lists are
+//  sorted in parallel pieces and merged.
+// ============================================================
+
+struct SortColumn {
+    std::vector<double> num;
+    std::vector<std::string> str;  // only filled when some key isn't a number
+    std::vector<char> isNum;
+    bool desc;
+    SortColumn(const IronArray& keys,bool descending):desc(descending){
+        num.resize(keys.size());isNum.resize(keys.size());
+        bool allNum=true;
+        for(size_t i=0;i<keys.size();i++){
+            if(auto*d=std::get_if<double>(&keys[i]->data)){num[i]=*d;isNum[i]=1;}else allNum=false;
+        }
+        if(!allNum){str.reserve(keys.size());for(auto&k:keys)str.push_back(k->toString());}
+    }
+    int compare(size_t a,size_t b) const {
+        int r;
+        if(isNum[a]&&isNum[b])r=num[a]<num[b]?-1:num[b]<num[a]?1:0;
+        else{int c=str[a].compare(str[b]);r=c<0?-1:c>0?1:0;}
+        return desc?-r:r;
+    }
+};
+
+static const size_t PARALLEL_SORT_MIN=1<<16;  // below this, threads cost more than they save
+
+// Run task(0..n-1), one per thread (the caller's included)
+static void runParallel(size_t n,const std::function<void(size_t)>& task){
+    std::vector<std::thread> threads;
+    size_t i=1;
+    try{for(;i<n;i++)threads.emplace_back(task,i);}
+    catch(std::system_error&){for(;i<n;i++)task(i);}  // no more threads to be had: do the rest here
+    task(0);
+    for(auto&t:threads)t.join();
+}
+
+template<class Less> static void stableSortParallel(std::vector<size_t>& v,Less less){
+    size_t parts=std::min<size_t>(std::thread::hardware_concurrency(),v.size()/(PARALLEL_SORT_MIN/2));
+    if(v.size()<PARALLEL_SORT_MIN||parts<2){std::stable_sort(v.begin(),v.end(),less);return;}
+    std::vector<size_t> edge(parts+1);
+    for(size_t i=0;i<=parts;i++)edge[i]=v.size()*i/parts;
+    runParallel(parts,[&](size_t i){std::stable_sort(v.begin()+edge[i],v.begin()+edge[i+1],less);});
+    // merge neighbouring runs, left before right so equal keys keep their order
+    for(size_t width=1;width<parts;width*=2){
+        size_t merges=(parts+2*width-1)/(2*width);
+        runParallel(merges,[&](size_t m){
+            size_t lo=m*2*width,mid=lo+width,hi=std::min(lo+2*width,parts);
+            if(mid<hi)std::inplace_merge(v.begin()+edge[lo],v.begin()+edge[mid],v.begin()+edge[hi],less);
+        });
+    }
+}
+
 // ============================================================
 //  INTERPRETER
 // ============================================================
 
 class Interpreter {
+    // v3.2: declared first, so it's destroyed last — after every value made from it
+    ValuePool valuePool;
+    // makes valuePool the thread's current pool while the interpreter is in use (calls nest)
+    struct UsePool {
+        ValuePool& pool;ValuePool* prev{nullptr};int entered{0};
+        explicit UsePool(ValuePool& p):pool(p){enter();}
+        ~UsePool(){if(entered)currentPool=prev;}
+        void enter(){if(!entered++){prev=currentPool;currentPool=&pool;}}
+        void leave(){if(!--entered)currentPool=prev;}
+    } usePool{valuePool};
+public:
+    // v3.2: this interpreter's limits — main fills them from the command line, an embedding Engine sets its own
+    struct Limits { size_t maxDepth{maxCallDepth}; size_t maxHeap{maxHeapBytes}; uint64_t maxSteps{::maxSteps}; double timeout{timeoutSeconds}; };
+    // keeps the interpreter's pool current on this thread for as long as it lives
+    struct Active { Interpreter& in; explicit Active(Interpreter& i):in(i){in.usePool.enter();} ~Active(){in.usePool.leave();} };
+private:
+    Limits limits;
+    std::ostream* out{&std::cout};  // where 'say' writes
+    std::vector<std::pair<std::string,ValuePtr>> builtins;  // globals every script starts with
     Env globalEnv;
     std::unordered_map<std::string,ClassDef> classRegistry;
     std::list<Env> moduleEnvs;  // keeps module envs alive so function closures don't dangle
-    std::list<StmtList> moduleAsts; // keeps module ASTs alive so IronFunc body ptrs don't dangle
+    std::vector<std::shared_ptr<const StmtList>> moduleAsts; // keeps module ASTs alive so IronFunc body ptrs don't dangle
+    // v3.2: loaded modules by canonical path — each is run once; later 'get's share its exports
+    struct CachedModule { std::filesystem::file_time_type mtime; ValuePtr exports; };
+    std::unordered_map<std::string,CachedModule> moduleCache;
+    ValuePtr stdlibModule;
+    class HttpPool;
+    class HttpReactor;
+    std::unique_ptr<HttpPool> httpPool;   // v3.2: keep-alive sockets + DNS cache, created on the first fetch
+    std::unique_ptr<HttpReactor> reactor; // v3.2: created on the first async fetch
+    // v3.2: call frames, preallocated in one block (reserved for limits.maxDepth, so they never move)
+    std::vector<Env> frames;
+    std::vector<Env*> callStack;          // the frame in use at each depth
+    std::list<Env> spareFrames;           // stand-ins for pool frames pinned by a closure
+    std::vector<Env*> freeFrames;         // pinned frames the cycle collector found unreachable
+    size_t depth{0};
+    uintptr_t stackBase{0};               // native stack top and usable size (0 = unknown)
+    size_t stackBudget{0};
+    // v3.2: for each walks its list in place. The first write to a list that a loop is walking
+    // hands the loop a copy of the old contents (copy-on-write), so it still sees the list as
+    // it was when the loop started, and the write lands on the shared list as always.
+    struct ListWalk { const IronArray* list; std::shared_ptr<IronArray> before; };
+    std::vector<ListWalk*> listWalks;
+    void beforeListWrite(const IronArray& list){
+        for(auto*w:listWalks)if(w->list==&list&&!w->before)w->before=makePooled<IronArray>(list);
+    }
+    ValuePtr retVal;                      // v3.2: set by 'return' (Flow::RETURN)
+    ValuePtr tailCallee;                  // v3.2: set by a tail 'return f(...)' (Flow::TAIL_CALL)
+    std::vector<ValuePtr> tailArgs;
 
     // ---- String interpolation ----
     std::string interpolate(const std::string& s,Env& env){
@@ -865,8 +2171,7 @@ class Interpreter {
                 size_t j=i+1;int depth=1;
                 while(j<s.size()&&depth>0){if(s[j]=='{')depth++;else if(s[j]=='}')depth--;if(depth>0)j++;}
                 std::string inner=s.substr(i+1,j-i-1);
-                Lexer lex(inner);auto toks=lex.tokenize();
-                Parser p(std::move(toks));auto stmts=p.parse();
+                Parser p(inner);auto stmts=p.parse();
                 if(!stmts.empty())if(auto*es=std::get_if<ExprStmt>(&stmts[0]->node))result+=evalExpr(*es->expr,env)->toString();
                 i=j+1;
             } else result+=s[i++];
@@ -876,32 +2181,235 @@ class Interpreter {
 
     // ---- Call a method on a class instance ----
     ValuePtr callMethod(ValuePtr instance,const IronFunc& method,std::vector<ValuePtr> args){
-        Env me;me.parent=method.closure;
-        me.define("self",instance);
-        for(size_t i=0;i<method.params.size();i++)
-            me.define(method.params[i],i<args.size()?args[i]:IronValue::makeNull());
-        try{execBlock(*method.body,me);}catch(ReturnSignal&r){return r.value;}
-        return IronValue::makeNull();
+        return invoke(method,std::move(args),instance);
     }
 
-    // ---- Evaluate expression ----
-    ValuePtr evalExpr(const Expr& expr,Env& env){
-        return std::visit([&](auto& node)->ValuePtr{
-            using T=std::decay_t<decltype(node)>;
+    // ---- Run an Ironwood function (v3.2: tail calls loop here, reusing one frame) ----
+    ValuePtr invoke(const IronFunc& fn,std::vector<ValuePtr> args,ValuePtr self=nullptr){
+        Env& fe=enterFrame();
+        struct Leave{Interpreter* in;Env& fe;~Leave(){in->leaveFrame(fe);}} leave{this,fe};
+        const IronFunc* f=&fn;
+        ValuePtr holder;  // keeps the current tail callee alive
+        for(;;){
+            fe.parent=f->closure;fe.outer=f->home;
+            if(self)fe.define("self",self);
+            for(size_t i=0;i<f->params.size();i++)fe.define(f->params[i],i<args.size()?args[i]:IronValue::makeNull());
+            Flow flow=execBlock(*f->body,fe);
+            if(flow==Flow::RETURN)return std::move(retVal);
+            if(flow!=Flow::TAIL_CALL)return IronValue::makeNull();
+            ValuePtr callee=std::move(tailCallee);args=std::move(tailArgs);
+            auto*next=std::get_if<IronFunc>(&callee->data);
+            // a closure made during this call still points at fe — it has to outlive the callee
+            if(!next||fe.captured)return callValue(callee,std::move(args));
+            fe.vars.clear();self=nullptr;
+            holder=std::move(callee);f=next;
+            safePoint();
+        }
+    }
 
-            if constexpr(std::is_same_v<T,NumberLit>) return IronValue::makeNum(node.value);
-            if constexpr(std::is_same_v<T,BoolLit>)   return IronValue::makeBool(node.value);
-            if constexpr(std::is_same_v<T,NullLit>)   return IronValue::makeNull();
-            if constexpr(std::is_same_v<T,StringLit>)  return IronValue::makeStr(interpolate(node.value,env));
-            if constexpr(std::is_same_v<T,VarExpr>)    return env.get(node.name);
+    Env& enterFrame(){
+        safePoint();
+        if(depth>=limits.maxDepth)
+            throw ThrowSignal{"Stack overflow — more than "+std::to_string(limits.maxDepth)+" calls deep (raise the limit with --max-depth)"};
+        char here;
+        if(stackBase&&stackBase-(uintptr_t)&here>stackBudget)
+            throw ThrowSignal{"Stack overflow — calls nested too deeply"};
+        if(depth==callStack.size()){frames.emplace_back();frames.back().frame=true;callStack.push_back(&frames.back());}
+        return *callStack[depth++];
+    }
+    void leaveFrame(Env& fe){
+        depth--;
+        if(fe.captured&&outlivesCall(fe)){
+            fe.pin();  // a closure still needs it: keep it, and give this depth a fresh frame
+            if(!freeFrames.empty()){callStack[depth]=freeFrames.back();freeFrames.pop_back();return;}
+            spareFrames.emplace_back();spareFrames.back().frame=true;
+            callStack[depth]=&spareFrames.back();
+            return;
+        }
+        fe.vars.clear();fe.closures.clear();fe.parent=fe.outer=nullptr;fe.captured=false;
+    }
+    // does a function made in this frame live on somewhere other than the frame's own variables?
+    static bool outlivesCall(const Env& fe){
+        if(fe.pinned)return true;
+        for(auto&w:fe.closures){
+            auto fn=w.lock();if(!fn)continue;
+            long refs=fn.use_count()-1;
+            for(auto&[k,v]:fe.vars)if(v==fn)refs--;
+            if(refs>0)return true;
+        }
+        return false;
+    }
 
-            if constexpr(std::is_same_v<T,ArrayLit>){
-                auto arr=std::make_shared<IronArray>();
+    // ---- v3.2: cycle collector ----
+    // Reference counting frees everything but cycles: a dict that holds itself, a parent and child
+    // pointing at each other, a closure stored in the frame it closes over. Those are found the way
+    // CPython does it: for every tracked list/dict/function, the references that come from other
+    // tracked values and from finished frames are subtracted from its use_count. Whatever is left
+    // comes from the running program (variables, temporaries, the call stack), so those values are
+    // the roots; anything the roots can't reach is garbage. Emptying the garbage breaks its cycles
+    // and shared_ptr frees the rest. Finished frames that no live closure needs go back to the pool.
+    struct GcStats { size_t collections{0},freedValues{0},freedFrames{0},peak{0}; double totalMs{0},maxMs{0}; } gc;
+    size_t gcThreshold{GC_MIN_THRESHOLD};
+    size_t gcAtBytes{SIZE_MAX};  // with --max-heap: also collect once usage reaches this
+    // ---- v3.2: step budget and timeout ----
+    // Loops and calls count steps. Only when the count reaches `nextCheck` (the step limit, or
+    // the next clock sample) does the slower check run, so the hot path is an add and a compare.
+    uint64_t steps{0},nextCheck{UINT64_MAX};
+    Deadline deadline;
+    int currentLine{0};  // line of the statement running now
+    void safePoint(){
+        if(++steps>=nextCheck)checkBudget();
+        gcSafePoint();
+    }
+    void checkBudget(){
+        if(limits.maxSteps&&steps>limits.maxSteps)
+            throw LimitSignal{"Line "+std::to_string(currentLine)+": stopped after "+std::to_string(limits.maxSteps)+" steps (--max-steps)"};
+        nextCheck=limits.maxSteps?limits.maxSteps+1:UINT64_MAX;
+        if(limits.timeout>0){
+            if(deadline.passed())timedOut();
+            nextCheck=std::min(nextCheck,steps+STEP_CLOCK_SAMPLE);
+        }
+    }
+    [[noreturn]] void timedOut(){
+        std::ostringstream t;t<<limits.timeout;
+        throw LimitSignal{"Line "+std::to_string(currentLine)+": stopped after "+t.str()+" seconds (--timeout)"};
+    }
+    // A wait that can block for any length of time (a command, a fetch, stdin): the limits are
+    // checked as soon as it returns, and a wait the deadline cut short is the --timeout error.
+    template<class F> auto blocking(F&& f)->decltype(f()){
+        try{
+            if constexpr(std::is_void_v<decltype(f())>){f();checkBudget();}
+            else{auto r=f();checkBudget();return r;}
+        }catch(const TimedOut&){timedOut();}
+    }
+    void gcSafePoint(){if(valuePool.trackedSince>=gcThreshold||valuePool.counters().bytes>=gcAtBytes)collectCycles();}
+    template<class F> static void eachChild(const IronValue& v,F&& f){
+        if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&v.data))for(auto&c:**ap)f(c);
+        else if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&v.data))for(auto&kv:**op)f(kv.second);
+    }
+    static const void* containerOf(const IronValue& v,long& uses){
+        if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&v.data)){uses=ap->use_count();return ap->get();}
+        if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&v.data)){uses=op->use_count();return op->get();}
+        return nullptr;
+    }
+    static bool trackable(const IronValue& v){
+        return std::holds_alternative<std::shared_ptr<IronArray>>(v.data)||std::holds_alternative<std::shared_ptr<IronObject>>(v.data)||
+               std::holds_alternative<IronFunc>(v.data);
+    }
+    // pointer → position in the collector's node list (open addressing; rebuilt every collection)
+    struct GcIndex {
+        std::vector<std::pair<const void*,uint32_t>> slots;size_t mask{0};
+        explicit GcIndex(size_t n){size_t cap=16;while(cap<n*2)cap<<=1;slots.assign(cap,{nullptr,0});mask=cap-1;}
+        static size_t hash(const void* p){return (size_t)(((uintptr_t)p>>4)*0x9E3779B97F4A7C15ull>>20);}
+        uint32_t* find(const void* p,bool add=false){
+            for(size_t i=hash(p)&mask;;i=(i+1)&mask){
+                if(slots[i].first==p)return &slots[i].second;
+                if(!slots[i].first){if(!add)return nullptr;slots[i].first=p;return &slots[i].second;}
+            }
+        }
+    };
+    void collectCycles(){
+        auto started=std::chrono::steady_clock::now();
+        // everything tracked that's still alive — held here, so nothing is freed until the end
+        auto& tracked=valuePool.tracked;
+        std::vector<ValuePtr> live;live.reserve(tracked.size());
+        for(auto*t:tracked)live.push_back(t->shared_from_this());
+        valuePool.trackedSince=0;
+        size_t n=live.size();
+        GcIndex index(n);
+        std::vector<long> refs(n);     // references not explained by the graph itself
+        std::vector<char> marked(n,0);
+        for(size_t i=0;i<n;i++){*index.find(live[i].get(),true)=(uint32_t)i;refs[i]=live[i].use_count()-1;}
+        auto unref=[&](const ValuePtr& c){if(c&&trackable(*c))if(auto*i=index.find(c.get()))refs[*i]--;};
+        // finished frames kept for a closure are part of the graph; running ones are roots
+        std::unordered_set<Env*> running(callStack.begin(),callStack.begin()+depth),finished;
+        for(auto&e:frames)if(e.pinned&&!running.count(&e))finished.insert(&e);
+        for(auto&e:spareFrames)if(e.pinned&&!running.count(&e))finished.insert(&e);
+        // a list/dict is walked once even when several values share it; shared with native
+        // code (a loop walking it, say) it's a root
+        struct Holders{long count{0};bool walked{false};};
+        std::unordered_map<const void*,Holders> shared;
+        long uses;
+        for(size_t i=0;i<n;i++)if(auto*c=containerOf(*live[i],uses);c&&uses>1)shared[c].count++;
+        for(size_t i=0;i<n;i++){
+            auto*c=containerOf(*live[i],uses);
+            if(!c)continue;
+            if(uses>1){
+                auto& h=shared[c];
+                if(uses>h.count)refs[i]++;
+                if(h.walked)continue;
+                h.walked=true;
+            }
+            eachChild(*live[i],unref);
+        }
+        for(Env* e:finished)for(auto&kv:e->vars)unref(kv.second);
+        // mark what the roots reach: values, and the finished frames their closures live in
+        std::unordered_set<const Env*> kept;
+        std::vector<uint32_t> todo;
+        auto reach=[&](const ValuePtr& v){
+            if(!v||!trackable(*v))return;
+            if(auto*i=index.find(v.get());i&&!marked[*i]){marked[*i]=1;todo.push_back(*i);}
+        };
+        auto keep=[&](Env* e){
+            for(;e&&(finished.count(e)||running.count(e))&&kept.insert(e).second;e=e->outer)
+                if(finished.count(e))for(auto&kv:e->vars)reach(kv.second);
+        };
+        for(size_t i=0;i<n;i++)if(refs[i]>0)reach(live[i]);
+        for(Env* e:running)keep(e);
+        for(auto&[name,cls]:classRegistry)keep(cls.definitionEnv);
+        while(!todo.empty()){
+            const IronValue& v=*live[todo.back()];todo.pop_back();
+            eachChild(v,reach);
+            if(auto*f=std::get_if<IronFunc>(&v.data))keep(f->home);
+        }
+        // sweep: empty the garbage (its contents die together once 'trash' goes)
+        std::vector<ValuePtr> trash;
+        size_t freed=0;
+        for(size_t i=0;i<n;i++){
+            if(marked[i])continue;
+            freed++;
+            auto& v=*live[i];
+            if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&v.data)){for(auto&c:**ap)trash.push_back(std::move(c));(*ap)->clear();}
+            else if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&v.data)){for(auto&kv:**op)trash.push_back(std::move(kv.second));(*op)->clear();}
+        }
+        for(Env* e:finished){
+            if(kept.count(e))continue;
+            for(auto&kv:e->vars)trash.push_back(std::move(kv.second));
+            e->vars.clear();e->closures.clear();e->parent=e->outer=nullptr;e->captured=e->pinned=false;
+            freeFrames.push_back(e);gc.freedFrames++;
+        }
+        trash.clear();
+        live.clear();
+        gcThreshold=std::max(GC_MIN_THRESHOLD,n-freed);
+        if(size_t limit=valuePool.limit){  // close to the limit, collect before it's hit
+            size_t used=valuePool.counters().bytes;
+            gcAtBytes=used+std::max(limit>used?(limit-used)/2:0,limit/16);
+        }
+        double ms=std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-started).count();
+        gc.collections++;gc.freedValues+=freed;gc.peak=std::max(gc.peak,n);
+        gc.totalMs+=ms;gc.maxMs=std::max(gc.maxMs,ms);
+    }
+
+    // ---- Evaluate expression ----
+    ValuePtr evalExpr(const Expr& expr,Env& env){
+        return std::visit([&](auto& node)->ValuePtr{
+            using T=std::decay_t<decltype(node)>;
+
+            if constexpr(std::is_same_v<T,NumberLit>) return IronValue::makeNum(node.value);
+            if constexpr(std::is_same_v<T,BoolLit>)   return IronValue::makeBool(node.value);
+            if constexpr(std::is_same_v<T,NullLit>)   return IronValue::makeNull();
+            if constexpr(std::is_same_v<T,StringLit>)  return IronValue::makeStr(interpolate(node.value,env));
+            if constexpr(std::is_same_v<T,VarExpr>)    return env.get(node.name);
+
+            if constexpr(std::is_same_v<T,ArrayLit>){
+                if(node.constant)return cloneConstant(node.constant);
+                auto arr=makePooled<IronArray>();
                 for(auto&e:node.elems)arr->push_back(evalExpr(*e,env));
                 return IronValue::makeArr(arr);
             }
             if constexpr(std::is_same_v<T,ObjectLit>){
-                auto obj=std::make_shared<IronObject>();
+                if(node.constant)return cloneConstant(node.constant);
+                auto obj=makePooled<IronObject>();
                 for(auto&[k,v]:node.pairs)(*obj)[k]=evalExpr(*v,env);
                 return IronValue::makeObj(obj);
             }
@@ -929,7 +2437,7 @@ class Interpreter {
             if constexpr(std::is_same_v<T,KeepWhereExpr>){
                 auto av=evalExpr(*node.arr,env);auto fn=evalExpr(*node.fn,env);
                 if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&av->data)){
-                    auto res=std::make_shared<IronArray>();
+                    auto res=makePooled<IronArray>();
                     for(auto&item:**ap)if(callValue(fn,{item})->isTruthy())res->push_back(item);
                     return IronValue::makeArr(res);
                 }
@@ -940,7 +2448,7 @@ class Interpreter {
             if constexpr(std::is_same_v<T,KeysOfExpr>){
                 auto val=evalExpr(*node.dict,env);
                 if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&val->data)){
-                    auto arr=std::make_shared<IronArray>();
+                    auto arr=makePooled<IronArray>();
                     for(auto&[k,v]:**op)if(k!="__class__")arr->push_back(IronValue::makeStr(k));
                     return IronValue::makeArr(arr);
                 }
@@ -950,7 +2458,7 @@ class Interpreter {
             if constexpr(std::is_same_v<T,ValuesOfExpr>){
                 auto val=evalExpr(*node.dict,env);
                 if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&val->data)){
-                    auto arr=std::make_shared<IronArray>();
+                    auto arr=makePooled<IronArray>();
                     for(auto&[k,v]:**op)if(k!="__class__")arr->push_back(v);
                     return IronValue::makeArr(arr);
                 }
@@ -990,7 +2498,7 @@ class Interpreter {
                 auto p=evalExpr(*node.path,env)->toString();
                 std::ifstream f(p);
                 if(!f)throw ThrowSignal{"Can't open file: "+p};
-                auto arr=std::make_shared<IronArray>();
+                auto arr=makePooled<IronArray>();
                 std::string ln;
                 while(std::getline(f,ln))arr->push_back(IronValue::makeStr(ln));
                 return IronValue::makeArr(arr);
@@ -1000,7 +2508,7 @@ class Interpreter {
                 auto it=classRegistry.find(node.className);
                 if(it==classRegistry.end())throw std::runtime_error("Unknown class: "+node.className+" — did you define it with 'class "+node.className+"'?");
                 auto& cd=it->second;
-                auto fields=std::make_shared<IronObject>();
+                auto fields=makePooled<IronObject>();
                 (*fields)["__class__"]=IronValue::makeStr(node.className);
                 // Initialize default field values
                 for(auto&[fname,defaultExpr]:cd.fields){
@@ -1019,29 +2527,13 @@ class Interpreter {
             }
 
             if constexpr(std::is_same_v<T,UnaryExpr>){
-                auto v=evalExpr(*node.operand,env);
-                if(node.op=="-"&&std::get_if<double>(&v->data))return IronValue::makeNum(-std::get<double>(v->data));
-                if(node.op=="not")return IronValue::makeBool(!v->isTruthy());
-                return IronValue::makeNull();
+                return unaryOp(node.op,evalExpr(*node.operand,env));
             }
             if constexpr(std::is_same_v<T,BinExpr>){
                 if(node.op=="and"){auto l=evalExpr(*node.left,env);return l->isTruthy()?evalExpr(*node.right,env):l;}
                 if(node.op=="or") {auto l=evalExpr(*node.left,env);return l->isTruthy()?l:evalExpr(*node.right,env);}
                 auto left=evalExpr(*node.left,env);auto right=evalExpr(*node.right,env);
-                const std::string& op=node.op;
-                auto*ln=std::get_if<double>(&left->data);auto*rn=std::get_if<double>(&right->data);
-                if(op=="+"){if(ln&&rn)return IronValue::makeNum(*ln+*rn);return IronValue::makeStr(left->toString()+right->toString());}
-                if(ln&&rn){
-                    if(op=="-")return IronValue::makeNum(*ln-*rn);
-                    if(op=="*")return IronValue::makeNum(*ln**rn);
-                    if(op=="/"){if(*rn==0)throw std::runtime_error("Can't divide by zero!");return IronValue::makeNum(*ln/ *rn);}
-                    if(op=="%")return IronValue::makeNum(std::fmod(*ln,*rn));
-                    if(op=="<")return IronValue::makeBool(*ln<*rn);if(op==">")return IronValue::makeBool(*ln>*rn);
-                    if(op=="<=")return IronValue::makeBool(*ln<=*rn);if(op==">=")return IronValue::makeBool(*ln>=*rn);
-                }
-                if(op=="==")return IronValue::makeBool(left->toString()==right->toString());
-                if(op=="!=")return IronValue::makeBool(left->toString()!=right->toString());
-                return IronValue::makeNull();
+                return binaryOp(node.op,left,right);
             }
 
             // ---- Member access (obj.field) — handles class instances ----
@@ -1051,7 +2543,7 @@ class Interpreter {
                     if(node.field=="length")return IronValue::makeNum((*ap)->size());
                     if(node.field=="map"){
                         return IronValue::makeNative([this,ap](std::vector<ValuePtr> args)->ValuePtr{
-                            auto res=std::make_shared<IronArray>();
+                            auto res=makePooled<IronArray>();
                             for(auto&item:**ap)res->push_back(callValue(args[0],{item}));
                             return IronValue::makeArr(res);
                         });
@@ -1107,7 +2599,9 @@ class Interpreter {
             // ---- v3.0: lambda ----
             if constexpr(std::is_same_v<T,FuncExpr>){
                 IronFunc f{node.params,&node.body,&env};
-                return IronValue::makeFunc(f);
+                auto fn=IronValue::makeFunc(f);
+                env.capture(fn);
+                return fn;
             }
             // ---- v3.0: ternary ----
             if constexpr(std::is_same_v<T,TernaryExpr>){
@@ -1117,7 +2611,7 @@ class Interpreter {
             if constexpr(std::is_same_v<T,SplitExpr>){
                 auto s=evalExpr(*node.str,env)->toString();
                 auto sep=evalExpr(*node.sep,env)->toString();
-                auto arr=std::make_shared<IronArray>();
+                auto arr=makePooled<IronArray>();
                 if(sep.empty()){for(char c:s)arr->push_back(IronValue::makeStr(std::string(1,c)));return IronValue::makeArr(arr);}
                 size_t p=0,f;
                 while((f=s.find(sep,p))!=std::string::npos){arr->push_back(IronValue::makeStr(s.substr(p,f-p)));p=f+sep.size();}
@@ -1185,40 +2679,42 @@ class Interpreter {
             // ---- v3.0: sort ----
             if constexpr(std::is_same_v<T,SortExpr>){
                 auto av=evalExpr(*node.arr,env);
-                if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&av->data)){
-                    auto copy=std::make_shared<IronArray>(**ap);
-                    if(node.key){
-                        // Field name shorthand: key is a StringLit (not callable) → extract field
-                        auto keyVal=evalExpr(*node.key,env);
-                        if(auto*field=std::get_if<std::string>(&keyVal->data)){
-                            // sort people by age  →  key is the string "age"
-                            std::stable_sort(copy->begin(),copy->end(),[&](const ValuePtr&a,const ValuePtr&b){
-                                ValuePtr ka=IronValue::makeNull(),kb=IronValue::makeNull();
-                                if(auto*oa=std::get_if<std::shared_ptr<IronObject>>(&a->data)){auto it=(*oa)->find(*field);if(it!=(*oa)->end())ka=it->second;}
-                                if(auto*ob=std::get_if<std::shared_ptr<IronObject>>(&b->data)){auto it=(*ob)->find(*field);if(it!=(*ob)->end())kb=it->second;}
-                                auto*na=std::get_if<double>(&ka->data),*nb=std::get_if<double>(&kb->data);
-                                if(na&&nb)return *na<*nb;
-                                return ka->toString()<kb->toString();
-                            });
-                        } else {
-                            // Lambda key: sort people by function(x) return x.score end
-                            std::stable_sort(copy->begin(),copy->end(),[&](const ValuePtr&a,const ValuePtr&b){
-                                auto ka=callValue(keyVal,{a}),kb=callValue(keyVal,{b});
-                                auto*na=std::get_if<double>(&ka->data),*nb=std::get_if<double>(&kb->data);
-                                if(na&&nb)return *na<*nb;
-                                return ka->toString()<kb->toString();
-                            });
+                auto*ap=std::get_if<std::shared_ptr<IronArray>>(&av->data);
+                if(!ap)return av;
+                // v3.2: a list nothing else can see (e.g. sort split s by ",") is sorted where it is
+                bool temp=av.use_count()==1&&ap->use_count()==1;
+                IronArray items=temp?std::move(**ap):**ap;
+                // decorate: every key is worked out once per item (a key function runs n times,
+                // not on every comparison), then the comparisons never leave C++
+                std::vector<SortColumn> cols;
+                if(node.keys.empty())cols.emplace_back(items,false);
+                for(auto&[keyExpr,desc]:node.keys){
+                    if(!keyExpr){cols.emplace_back(items,desc);continue;}
+                    auto keyVal=evalExpr(*keyExpr,env);
+                    IronArray keys;keys.reserve(items.size());
+                    if(auto*field=std::get_if<std::string>(&keyVal->data)){
+                        // sort people by age  →  key is the string "age"
+                        for(auto&item:items){
+                            ValuePtr k=IronValue::makeNull();
+                            if(auto*o=std::get_if<std::shared_ptr<IronObject>>(&item->data)){auto it=(*o)->find(*field);if(it!=(*o)->end())k=it->second;}
+                            keys.push_back(k);
                         }
-                    } else {
-                        std::stable_sort(copy->begin(),copy->end(),[](const ValuePtr&a,const ValuePtr&b){
-                            auto*na=std::get_if<double>(&a->data),*nb=std::get_if<double>(&b->data);
-                            if(na&&nb)return *na<*nb;
-                            return a->toString()<b->toString();
-                        });
                     }
-                    return IronValue::makeArr(copy);
+                    // Lambda key: sort people by function(x) return x.score end
+                    else for(auto&item:items)keys.push_back(callValue(keyVal,{item}));
+                    cols.emplace_back(keys,desc);
                 }
-                return av;
+                std::vector<size_t> order(items.size());
+                for(size_t i=0;i<order.size();i++)order[i]=i;
+                stableSortParallel(order,[&](size_t a,size_t b){
+                    for(auto&c:cols){int r=c.compare(a,b);if(r)return r<0;}
+                    return false;
+                });
+                // undecorate
+                auto out=temp?*ap:makePooled<IronArray>();
+                out->clear();out->reserve(order.size());
+                for(size_t i:order)out->push_back(std::move(items[i]));
+                return temp?av:IronValue::makeArr(out);
             }
             // ---- v3.0: json of / parse json ----
             if constexpr(std::is_same_v<T,JsonOfExpr>){
@@ -1228,13 +2724,48 @@ class Interpreter {
                 auto s=evalExpr(*node.str,env)->toString();
                 size_t p=0;return jsonToIron(s,p);
             }
+            // ---- v3.2: parse csv / csv file / csv of ----
+            if constexpr(std::is_same_v<T,CsvExpr>){
+                auto arr=makePooled<IronArray>();
+                eachCsvRow(node,env,[&](ValuePtr row){arr->push_back(std::move(row));return true;});
+                return IronValue::makeArr(arr);
+            }
+            if constexpr(std::is_same_v<T,CsvOfExpr>){
+                auto rows=evalExpr(*node.val,env);
+                std::shared_ptr<IronArray> cols;
+                if(node.opts){
+                    auto opts=evalExpr(*node.opts,env);
+                    if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&opts->data)){
+                        auto c=(*op)->find("columns");
+                        if(c!=(*op)->end()){
+                            auto*cp=std::get_if<std::shared_ptr<IronArray>>(&c->second->data);
+                            if(!cp)throw std::runtime_error("'csv of': columns must be a list of names, like {columns: [\"id\", \"name\"]}");
+                            cols=*cp;
+                        }
+                    }
+                }
+                return IronValue::makeStr(csvText(rows,cols.get()));
+            }
+            if constexpr(std::is_same_v<T,MemoryExpr>) return IronValue::makeNum((double)valuePool.counters().bytes);
             // ---- v3.1: fetch / run ----
-            if constexpr(std::is_same_v<T,FetchExpr>) return evalFetch(node,env);
+            if constexpr(std::is_same_v<T,FetchExpr>) return evalFetch(node,env,node.async);
+            // ---- v3.2: sum / min / max / average of a list of numbers ----
+            if constexpr(std::is_same_v<T,ReduceExpr>){
+                auto lv=evalExpr(*node.list,env);
+                auto*ap=std::get_if<std::shared_ptr<IronArray>>(&lv->data);
+                if(!ap)throw std::runtime_error("'"+node.op+" of' needs a list of numbers.");
+                return reduceNumbers(node.op,**ap);
+            }
+            if constexpr(std::is_same_v<T,AwaitExpr>){
+                // await fetch ... → start everything first, then wait for all of it together
+                if(auto*fe=std::get_if<FetchExpr>(&node.val->node))return awaitValue(evalFetch(*fe,env,true));
+                return awaitValue(evalExpr(*node.val,env));
+            }
             if constexpr(std::is_same_v<T,RunExpr>)   return evalRun(node,env);
             if constexpr(std::is_same_v<T,AskExpr>){
                 std::string prompt=evalExpr(*node.prompt,env)->toString();
-                if(!prompt.empty())std::cout<<prompt<<" ";
-                std::string input;std::getline(std::cin,input);
+                if(!prompt.empty())*out<<prompt<<" "<<std::flush;
+                std::string input;blocking([&]{std::getline(std::cin,input);});
                 return IronValue::makeStr(input);
             }
 
@@ -1263,31 +2794,114 @@ class Interpreter {
         else{p.host=hostport;p.port=(p.scheme=="https"?443:80);}
         return p;
     }
-    struct HttpResponse { std::string body; int status; };
-    static HttpResponse httpRequest(const std::string& method,const std::string& rawUrl,
-                                    const std::string& body,const std::unordered_map<std::string,std::string>& extraHeaders,
-                                    int redirectsLeft=8){
-        if(redirectsLeft==0)throw std::runtime_error("Too many HTTP redirects");
-        auto u=parseUrl(rawUrl);
-        if(u.scheme=="https")throw std::runtime_error("HTTPS requires libcurl — use http:// or install libcurl4-openssl-dev");
-        // open socket
-        struct addrinfo hints{},*res=nullptr;
-        hints.ai_family=AF_INET;hints.ai_socktype=SOCK_STREAM;
-        std::string portStr=std::to_string(u.port);
-        if(getaddrinfo(u.host.c_str(),portStr.c_str(),&hints,&res)!=0||!res)
-            throw std::runtime_error("Can't resolve host: "+u.host);
-        int fd=socket(res->ai_family,res->ai_socktype,res->ai_protocol);
-        if(fd<0){freeaddrinfo(res);throw std::runtime_error("Socket error");}
-        if(connect(fd,res->ai_addr,res->ai_addrlen)<0){
-            freeaddrinfo(res);close(fd);
-            throw std::runtime_error("Can't connect to "+u.host+":"+portStr);
+    struct HttpResponse { std::string body; int status; std::string location; size_t bytes{0}; };
+    static void setNonBlocking(int fd,bool on=true){
+#ifdef _WIN32
+        u_long mode=on?1:0;ioctlsocket(fd,FIONBIO,&mode);
+#else
+        int fl=fcntl(fd,F_GETFL,0);
+        fcntl(fd,F_SETFL,on?(fl|O_NONBLOCK):(fl&~O_NONBLOCK));
+#endif
+    }
+    static bool wouldBlock(){
+#ifdef _WIN32
+        int e=WSAGetLastError();return e==WSAEWOULDBLOCK||e==WSAEINPROGRESS;
+#else
+        return errno==EINPROGRESS||errno==EAGAIN||errno==EWOULDBLOCK;
+#endif
+    }
+    // wait until fd is ready for `events` (POLLIN / POLLOUT); false if the deadline came first
+    static bool waitForSocket(int fd,short events,const Deadline& dl){
+        if(!dl.set)return true;
+        pollfd pf{};pf.fd=fd;pf.events=events;
+        for(;;){
+            int ready=poll(&pf,1,dl.waitMs());
+            if(ready<0&&errno==EINTR)continue;
+            return ready!=0;
         }
-        freeaddrinfo(res);
-        // build request
+    }
+    static bool sendAll(int fd,const std::string& data,const Deadline& dl={}){
+        size_t sent=0;
+        while(sent<data.size()){
+            ssize_t n=send(fd,data.c_str()+sent,data.size()-sent,MSG_NOSIGNAL);
+            if(n<0&&wouldBlock()&&waitForSocket(fd,POLLOUT,dl))continue;
+            if(n<=0)return false;
+            sent+=n;
+        }
+        return true;
+    }
+
+    // ================================================================
+    //  v3.2 — Connection pool: HTTP/1.1 keep-alive sockets per host:port,
+    //  plus a small DNS cache so repeat requests skip getaddrinfo
+    // ================================================================
+    class HttpPool {
+        struct Resolved {
+            sockaddr_storage addr;socklen_t len;
+            std::chrono::steady_clock::time_point expires;
+        };
+        std::unordered_map<std::string,Resolved> dns;            // "host:port" → address
+        std::unordered_map<std::string,std::vector<int>> idle;   // "host:port" → reusable sockets
+        static std::string key(const ParsedUrl& u){return u.host+":"+std::to_string(u.port);}
+        const Resolved& resolve(const ParsedUrl& u){
+            auto now=std::chrono::steady_clock::now();
+            auto it=dns.find(key(u));
+            if(it!=dns.end()&&it->second.expires>now)return it->second;
+            struct addrinfo hints{},*res=nullptr;
+            hints.ai_family=AF_INET;hints.ai_socktype=SOCK_STREAM;
+            if(getaddrinfo(u.host.c_str(),std::to_string(u.port).c_str(),&hints,&res)!=0||!res)
+                throw std::runtime_error("Can't resolve host: "+u.host);
+            Resolved r{};
+            std::memcpy(&r.addr,res->ai_addr,res->ai_addrlen);r.len=(socklen_t)res->ai_addrlen;
+            r.expires=now+std::chrono::seconds(DNS_TTL_SECONDS);
+            freeaddrinfo(res);
+            return dns[key(u)]=r;
+        }
+        // An idle socket the server has since closed reads as EOF (or has stray bytes) — drop it
+        static bool stillOpen(int fd){
+            setNonBlocking(fd);
+            char c;ssize_t n=recv(fd,&c,1,MSG_PEEK);
+            return n<0&&wouldBlock();
+        }
+    public:
+        static constexpr int    DNS_TTL_SECONDS=60;
+        static constexpr size_t MAX_IDLE_PER_HOST=8;
+        ~HttpPool(){for(auto&[k,fds]:idle)for(int fd:fds)close(fd);}
+        // An idle keep-alive socket when one is available (reused=true), otherwise a new connection.
+        // A new non-blocking socket may still be connecting on return.
+        int acquire(const ParsedUrl& u,bool nonBlocking,bool& reused,bool fresh=false){
+            reused=false;
+            auto it=idle.find(key(u));
+            while(!fresh&&it!=idle.end()&&!it->second.empty()){
+                int fd=it->second.back();it->second.pop_back();
+                if(!stillOpen(fd)){close(fd);continue;}
+                setNonBlocking(fd,nonBlocking);
+                reused=true;
+                return fd;
+            }
+            const Resolved& r=resolve(u);
+            int fd=openSocket(r.addr.ss_family,SOCK_STREAM,0);
+            if(fd<0)throw std::runtime_error("Socket error");
+            if(nonBlocking)setNonBlocking(fd);
+            if(connect(fd,(const sockaddr*)&r.addr,r.len)<0&&!(nonBlocking&&wouldBlock())){
+                close(fd);
+                dns.erase(key(u));  // the address may be stale — resolve again next time
+                throw std::runtime_error("Can't connect to "+u.host+":"+std::to_string(u.port));
+            }
+            return fd;
+        }
+        void release(const ParsedUrl& u,int fd){
+            auto& fds=idle[key(u)];
+            if(fds.size()>=MAX_IDLE_PER_HOST){close(fd);return;}
+            fds.push_back(fd);
+        }
+    };
+
+    static std::string buildHttpRequest(const std::string& method,const ParsedUrl& u,
+                                        const std::string& body,const std::unordered_map<std::string,std::string>& extraHeaders){
         std::string req=method+" "+u.path+" HTTP/1.1\r\n";
         req+="Host: "+u.host+"\r\n";
-        req+="Connection: close\r\n";
-        req+="User-Agent: Ironwood/3.1\r\n";
+        req+="User-Agent: Ironwood/3.2\r\n";
         for(auto&[k,v]:extraHeaders)req+=k+": "+v+"\r\n";
         if(!body.empty()){
             req+="Content-Length: "+std::to_string(body.size())+"\r\n";
@@ -1295,269 +2909,1347 @@ class Interpreter {
                 req+="Content-Type: application/x-www-form-urlencoded\r\n";
         }
         req+="\r\n"+body;
-        // send
-        size_t sent=0;
-        while(sent<req.size()){
-            ssize_t n=send(fd,req.c_str()+sent,req.size()-sent,0);
-            if(n<=0){close(fd);throw std::runtime_error("Send failed");}
-            sent+=n;
-        }
-        // receive
-        std::string raw;
-        char buf[4096];
-        ssize_t n;
-        while((n=recv(fd,buf,sizeof(buf),0))>0)raw.append(buf,n);
-        close(fd);
-        // parse status line
-        size_t nl=raw.find("\r\n");
-        if(nl==std::string::npos)throw std::runtime_error("Bad HTTP response");
-        std::string statusLine=raw.substr(0,nl);
-        int status=0;
-        {size_t sp=statusLine.find(' ');if(sp!=std::string::npos)status=std::stoi(statusLine.substr(sp+1,3));}
-        // parse headers
-        std::string lower;lower.resize(raw.size());
-        std::transform(raw.begin(),raw.end(),lower.begin(),::tolower);
-        size_t headerEnd=raw.find("\r\n\r\n");
-        if(headerEnd==std::string::npos)return {raw,status};
-        std::string headerBlock=raw.substr(0,headerEnd);
-        std::string rawBody=raw.substr(headerEnd+4);
-        // redirect?
-        if(status>=300&&status<400){
-            size_t li=headerBlock.find("\r\nlocation:");
-            if(li!=std::string::npos){
-                size_t le=headerBlock.find("\r\n",li+2);
-                std::string loc=headerBlock.substr(li+13,(le==std::string::npos?headerBlock.size():le)-(li+13));
-                while(!loc.empty()&&(loc.back()==' '||loc.back()=='\r'))loc.pop_back();
-                if(!loc.empty()&&loc[0]=='/')loc=u.scheme+"://"+u.host+(u.port==80?"":":"+portStr)+loc;
-                return httpRequest("GET",loc,"",{},redirectsLeft-1);
-            }
-        }
-        // chunked transfer decoding
-        std::string lowerHeaders=lower.substr(0,headerEnd);
-        if(lowerHeaders.find("transfer-encoding: chunked")!=std::string::npos){
-            std::string decoded;
-            size_t p=0;
-            while(p<rawBody.size()){
-                size_t crlf=rawBody.find("\r\n",p);
-                if(crlf==std::string::npos)break;
-                size_t chunkSize=std::stoul(rawBody.substr(p,crlf-p),nullptr,16);
-                if(chunkSize==0)break;
-                p=crlf+2;
-                decoded+=rawBody.substr(p,chunkSize);
-                p+=chunkSize+2;
-            }
-            return {decoded,status};
-        }
-        return {rawBody,status};
+        return req;
     }
-
     // ================================================================
-    //  v3.1 — Subprocess via popen
+    //  v3.2 — Incremental response parser
+    //  Fed bytes as they arrive; tracks status line → headers → body
+    //  (Content-Length, chunked, or until close). Only header names are
+    //  lowercased, and body bytes go straight to `sink` (or `body`) with
+    //  no intermediate copy of the whole response.
     // ================================================================
-    static std::pair<std::string,int> runCommand(const std::string& cmd){
-        FILE* pipe=popen((cmd+" 2>&1").c_str(),"r");
-        if(!pipe)throw std::runtime_error("Can't run command: "+cmd);
-        std::string out;char buf[256];
-        while(fgets(buf,sizeof(buf),pipe))out+=buf;
-        int code=pclose(pipe);
-        return {out,WIFEXITED(code)?WEXITSTATUS(code):1};
-    }
+    class HttpResponseParser {
+        enum State{STATUS,HEADERS,BODY_LENGTH,CHUNK_SIZE,CHUNK_DATA,CHUNK_END,TRAILERS,BODY_EOF,DONE} state{STATUS};
+        std::string line;            // partial status/header/chunk-size line
+        unsigned long long remaining{0};
+        bool noBody;
+        static constexpr size_t MAX_LINE=64*1024;
 
-    // ================================================================
-    //  v3.1 — Eval: FetchExpr + RunExpr
-    // ================================================================
-    ValuePtr evalFetch(const FetchExpr& node,Env& env){
-        auto url=evalExpr(*node.url,env)->toString();
-        std::string method="GET",body;
-        std::unordered_map<std::string,std::string> headers;
-        if(node.opts){
-            auto opts=evalExpr(*node.opts,env);
-            if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&opts->data)){
-                auto get=[&](const std::string&k)->std::string{
-                    auto it=(*op)->find(k);return it!=(*op)->end()?it->second->toString():"";
-                };
-                if(auto m=get("method");!m.empty()){method=m;for(auto&c:method)c=::toupper(c);}
-                body=get("body");
-                // headers sub-dict
-                auto hit=(*op)->find("headers");
-                if(hit!=(*op)->end()){
-                    if(auto*hp=std::get_if<std::shared_ptr<IronObject>>(&hit->second->data))
-                        for(auto&[k,v]:**hp)headers[k]=v->toString();
+        void emit(const char* d,size_t n){
+            if(discard||!n)return;
+            bytes+=n;
+            if(sink)sink(d,n);else body.append(d,n);
+        }
+        static std::string lowered(std::string s){for(auto&c:s)c=::tolower(c);return s;}
+        void headersDone(){
+            if(status/100==1){headers.clear();state=STATUS;return;}  // interim (100 Continue) — real status follows
+            auto te=headers.find("transfer-encoding");
+            auto cl=headers.find("content-length");
+            auto conn=headers.find("connection");
+            if(conn!=headers.end()){
+                auto v=lowered(conn->second);
+                if(v.find("close")!=std::string::npos)keepAlive=false;
+                else if(v.find("keep-alive")!=std::string::npos)keepAlive=true;
+            }
+            discard=status>=300&&status<400&&headers.count("location");  // redirect bodies are never wanted
+            if(noBody||status==204||status==304){state=DONE;return;}
+            if(te!=headers.end()&&lowered(te->second).find("chunked")!=std::string::npos){state=CHUNK_SIZE;return;}
+            if(cl!=headers.end()){
+                remaining=std::strtoull(cl->second.c_str(),nullptr,10);
+                if(!sink&&!discard)body.reserve((size_t)std::min<unsigned long long>(remaining,1ull<<30));
+                state=remaining?BODY_LENGTH:DONE;
+                return;
+            }
+            keepAlive=false;state=BODY_EOF;
+        }
+        void onLine(){
+            switch(state){
+                case STATUS:{
+                    if(line.empty())return;  // tolerate stray CRLF between responses
+                    if(line.compare(0,5,"HTTP/")!=0)throw std::runtime_error("Bad HTTP response");
+                    size_t sp=line.find(' ');
+                    status=sp==std::string::npos?0:std::atoi(line.c_str()+sp+1);
+                    keepAlive=line.compare(0,8,"HTTP/1.1")==0;
+                    state=HEADERS;
+                    return;
+                }
+                case HEADERS:{
+                    if(line.empty()){headersDone();return;}
+                    size_t c=line.find(':');
+                    if(c==std::string::npos)return;
+                    size_t vs=line.find_first_not_of(" \t",c+1),ve=line.find_last_not_of(" \t");
+                    headers[lowered(line.substr(0,c))]=vs==std::string::npos?"":line.substr(vs,ve-vs+1);
+                    return;
                 }
+                case CHUNK_SIZE:{
+                    char* end=nullptr;
+                    remaining=std::strtoull(line.c_str(),&end,16);
+                    if(end==line.c_str())throw std::runtime_error("Bad chunked encoding");
+                    state=remaining?CHUNK_DATA:TRAILERS;
+                    return;
+                }
+                case CHUNK_END: state=CHUNK_SIZE;return;
+                case TRAILERS:  if(line.empty())state=DONE;return;
+                default: return;
             }
         }
-        try{
-            auto resp=httpRequest(method,url,body,headers);
-            auto obj=std::make_shared<IronObject>();
-            (*obj)["body"]  =IronValue::makeStr(resp.body);
-            (*obj)["status"]=IronValue::makeNum(resp.status);
-            (*obj)["ok"]    =IronValue::makeBool(resp.status>=200&&resp.status<300);
-            return IronValue::makeObj(obj);
-        }catch(std::exception&e){
-            auto obj=std::make_shared<IronObject>();
-            (*obj)["body"]  =IronValue::makeStr(e.what());
-            (*obj)["status"]=IronValue::makeNum(0);
-            (*obj)["ok"]    =IronValue::makeBool(false);
-            return IronValue::makeObj(obj);
+    public:
+        int status{0};
+        bool keepAlive{false},discard{false};
+        std::unordered_map<std::string,std::string> headers;  // lowercased name → value
+        std::string body;
+        size_t bytes{0};
+        std::function<void(const char*,size_t)> sink;          // when set, body bytes stream here instead
+
+        explicit HttpResponseParser(bool headRequest=false):noBody(headRequest){}
+        bool done() const {return state==DONE;}
+        bool started() const {return state!=STATUS||!line.empty();}
+        // Consume up to n bytes; stops once the response is complete
+        void feed(const char* d,size_t n){
+            size_t i=0;
+            while(i<n&&state!=DONE){
+                if(state==BODY_LENGTH||state==CHUNK_DATA){
+                    size_t k=(size_t)std::min<unsigned long long>(remaining,n-i);
+                    emit(d+i,k);i+=k;remaining-=k;
+                    if(!remaining)state=state==BODY_LENGTH?DONE:CHUNK_END;
+                    continue;
+                }
+                if(state==BODY_EOF){emit(d+i,n-i);return;}
+                const char* nl=(const char*)std::memchr(d+i,'\n',n-i);
+                size_t end=nl?(size_t)(nl-d)+1:n;
+                line.append(d+i,end-i);i=end;
+                if(line.size()>MAX_LINE)throw std::runtime_error("HTTP header line too long");
+                if(!nl)return;
+                line.pop_back();if(!line.empty()&&line.back()=='\r')line.pop_back();
+                onLine();line.clear();
+            }
         }
+        // The server closed the connection: ends a close-delimited body; a Content-Length or
+        // chunked body that isn't all there yet was cut short (only trailers may be missing)
+        void finishEof(){
+            if(state==STATUS)throw std::runtime_error("Bad HTTP response");
+            if(state!=BODY_EOF&&state!=TRAILERS)throw std::runtime_error("Incomplete HTTP response — the connection closed before the body ended");
+            keepAlive=false;state=DONE;
+        }
+        std::string header(const std::string& lowerName) const {auto it=headers.find(lowerName);return it==headers.end()?"":it->second;}
+    };
+    static std::string resolveLocation(const std::string& loc,const ParsedUrl& u){
+        if(!loc.empty()&&loc[0]=='/')return u.scheme+"://"+u.host+(u.port==80?"":":"+std::to_string(u.port))+loc;
+        return loc;
     }
-    ValuePtr evalRun(const RunExpr& node,Env& env){
-        auto cmd=evalExpr(*node.cmd,env)->toString();
-        auto[output,code]=runCommand(cmd);
-        auto obj=std::make_shared<IronObject>();
-        (*obj)["output"]=IronValue::makeStr(output);
-        (*obj)["code"]  =IronValue::makeNum(code);
-        (*obj)["ok"]    =IronValue::makeBool(code==0);
-        return IronValue::makeObj(obj);
+    static HttpResponse responseFrom(HttpResponseParser& ps,const ParsedUrl& u){
+        HttpResponse r{std::move(ps.body),ps.status,""};
+        r.bytes=ps.bytes;
+        if(ps.discard)r.location=resolveLocation(ps.header("location"),u);
+        return r;
+    }
+    // Points the parser's body sink at a download; a failed write (disk full...) fails the fetch
+    static void sinkTo(HttpResponseParser& ps,std::ofstream* out,const std::string& path){
+        ps.sink=[out,path](const char* d,size_t n){if(!out->write(d,n))throw std::runtime_error("Can't write to file: "+path);};
+    }
+    // Opens `toFile` (when given) and points the parser's body sink at it
+    static std::unique_ptr<std::ofstream> streamTo(HttpResponseParser& ps,const std::string& toFile){
+        if(toFile.empty())return nullptr;
+        auto f=std::make_unique<std::ofstream>(toFile,std::ios::binary);
+        if(!*f)throw std::runtime_error("Can't write to file: "+toFile);
+        sinkTo(ps,f.get(),toFile);
+        return f;
+    }
+    // A download that didn't complete is removed rather than left looking like a whole file
+    static void dropDownload(std::unique_ptr<std::ofstream>& f,const std::string& path){
+        if(!f)return;
+        f.reset();
+        std::error_code ec;
+        if(std::filesystem::is_regular_file(path,ec))std::filesystem::remove(path,ec);  // never a device or pipe
+    }
+    static void closeDownload(std::unique_ptr<std::ofstream>& f,const std::string& path){
+        if(!f)return;
+        f->close();
+        if(f->fail()){dropDownload(f,path);throw std::runtime_error("Can't write to file: "+path);}
+        f.reset();
+    }
+    // Socket waits end at the deadline with TimedOut (connecting, sending and each read)
+    static HttpResponse httpRequest(HttpPool& pool,const Deadline& dl,const std::string& method,const std::string& rawUrl,
+                                    const std::string& body,const std::unordered_map<std::string,std::string>& extraHeaders,
+                                    const std::string& toFile="",int redirectsLeft=8){
+        if(redirectsLeft==0)throw std::runtime_error("Too many HTTP redirects");
+        auto u=parseUrl(rawUrl);
+        if(u.scheme=="https")throw std::runtime_error("HTTPS requires libcurl — use http:// or install libcurl4-openssl-dev");
+        std::string req=buildHttpRequest(method,u,body,extraHeaders);
+        for(bool retried=false;;retried=true){
+            bool reused;
+            int fd=pool.acquire(u,dl.set,reused,retried);
+            // with a deadline the socket is non-blocking, and every wait on it is a poll that ends there
+            if(!reused&&!waitForSocket(fd,POLLOUT,dl)){close(fd);throw TimedOut{};}
+            if(!sendAll(fd,req,dl)){
+                if(dl.passed()){close(fd);throw TimedOut{};}
+                close(fd);
+                if(reused&&!retried)continue;  // the server dropped an idle connection — retry on a fresh one
+                throw std::runtime_error("Send failed");
+            }
+            // receive, parsing as the bytes arrive
+            HttpResponseParser ps(method=="HEAD");
+            auto file=streamTo(ps,toFile);
+            char buf[16384];
+            try{
+                while(!ps.done()){
+                    if(!waitForSocket(fd,POLLIN,dl))throw TimedOut{};
+                    ssize_t n=recv(fd,buf,sizeof(buf),0);
+                    if(n<0&&wouldBlock())continue;
+                    if(n<=0){
+                        if(!ps.started()&&reused&&!retried)break;
+                        ps.finishEof();
+                        break;
+                    }
+                    ps.feed(buf,n);
+                }
+            }catch(...){close(fd);dropDownload(file,toFile);throw;}
+            if(!ps.done()){close(fd);continue;}
+            if(ps.keepAlive)pool.release(u,fd);else close(fd);
+            auto resp=responseFrom(ps,u);
+            closeDownload(file,toFile);
+            if(!resp.location.empty())return httpRequest(pool,dl,"GET",resp.location,"",{},toFile,redirectsLeft-1);
+            return resp;
+        }
     }
 
-    // ---- v3.1 JSON helpers ----
-    std::string ironToJson(ValuePtr v){
-        if(std::get_if<std::nullptr_t>(&v->data))return "null";
-        if(auto*b=std::get_if<bool>(&v->data))return *b?"true":"false";
-        if(auto*n=std::get_if<double>(&v->data)){
-            if(*n==std::floor(*n)&&std::abs(*n)<1e15)return std::to_string((long long)*n);
-            std::ostringstream o;o<<*n;return o.str();
+    // ================================================================
+    //  v3.2 — Async fetch reactor
+    //  Each "async fetch" becomes a non-blocking socket driven through
+    //  connect → send → receive by a single epoll loop (poll() where
+    //  epoll is unavailable). "await" pumps the loop until the requests
+    //  it needs are done, so every other in-flight request progresses
+    //  at the same time. Sockets come from, and return to, the HttpPool.
+    // ================================================================
+    class HttpReactor {
+        struct Pending {
+            enum Phase{CONNECTING,SENDING,RECEIVING,DONE} phase{CONNECTING};
+            int fd{-1};
+            bool reused{false},retried{false};
+            std::string method,body,toFile;
+            std::unordered_map<std::string,std::string> headers;
+            ParsedUrl url;
+            int redirectsLeft{8};
+            std::string out;
+            size_t sent{0};
+            HttpResponseParser parser;
+            std::unique_ptr<std::ofstream> file;
+            HttpResponse resp{"",0,""};
+            std::string error;
+        };
+        HttpPool& pool;
+        std::unordered_map<int,Pending> pending;   // request id → state
+        std::unordered_map<int,int> byFd;          // socket → request id
+        std::vector<int> restarts;                 // redirects/retries, begun after the current batch of events
+        int nextId{1};
+#ifdef __linux__
+        int epfd{-1};
+#endif
+
+        void watch(int fd,bool wantWrite,bool added){
+#ifdef __linux__
+            epoll_event ev{};ev.events=wantWrite?EPOLLOUT:EPOLLIN;ev.data.fd=fd;
+            epoll_ctl(epfd,added?EPOLL_CTL_MOD:EPOLL_CTL_ADD,fd,&ev);
+#else
+            (void)fd;(void)wantWrite;(void)added;  // poll() rebuilds its set from each request's phase
+#endif
         }
-        if(auto*s=std::get_if<std::string>(&v->data)){
-            std::string out="\"";
-            for(char c:*s){if(c=='"')out+="\\\"";else if(c=='\\')out+="\\\\";else if(c=='\n')out+="\\n";else if(c=='\t')out+="\\t";else out+=c;}
-            return out+"\"";
+        // Stop watching p's socket; it is then closed or handed back to the pool
+        void unwatch(Pending& p,bool keep=false){
+            if(p.fd<0)return;
+#ifdef __linux__
+            epoll_ctl(epfd,EPOLL_CTL_DEL,p.fd,nullptr);
+#endif
+            byFd.erase(p.fd);
+            if(keep)pool.release(p.url,p.fd);else close(p.fd);
+            p.fd=-1;
         }
-        if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&v->data)){
-            std::string out="[";
-            for(size_t i=0;i<(*ap)->size();i++){if(i)out+=",";out+=ironToJson((**ap)[i]);}
-            return out+"]";
+        void fail(Pending& p,const std::string& msg){unwatch(p);dropDownload(p.file,p.toFile);p.error=msg;p.phase=Pending::DONE;}
+        void begin(int id,Pending& p){
+            try{
+                if(p.redirectsLeft==0)throw std::runtime_error("Too many HTTP redirects");
+                if(p.url.scheme=="https")throw std::runtime_error("HTTPS requires libcurl — use http:// or install libcurl4-openssl-dev");
+                p.out=buildHttpRequest(p.method,p.url,p.body,p.headers);
+                p.sent=0;
+                p.parser=HttpResponseParser(p.method=="HEAD");
+                if(p.file)sinkTo(p.parser,p.file.get(),p.toFile);
+                p.fd=pool.acquire(p.url,true,p.reused,p.retried);
+                byFd[p.fd]=id;
+                p.phase=p.reused?Pending::SENDING:Pending::CONNECTING;
+                watch(p.fd,true,false);
+            }catch(std::exception&e){fail(p,e.what());}
         }
-        if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&v->data)){
-            std::string out="{";bool first=true;
-            for(auto&[k,val]:**op){
-                if(k=="__class__")continue;
-                if(!first)out+=",";out+="\""+k+"\":"+ironToJson(val);first=false;
+        void finish(int id,Pending& p){
+            unwatch(p,p.parser.keepAlive);
+            p.resp=responseFrom(p.parser,p.url);
+            if(!p.resp.location.empty()){
+                try{p.url=parseUrl(p.resp.location);}catch(std::exception&e){fail(p,e.what());return;}
+                p.method="GET";p.body.clear();p.headers.clear();
+                p.redirectsLeft--;p.retried=false;
+                restarts.push_back(id);
+                return;
             }
-            return out+"}";
+            try{closeDownload(p.file,p.toFile);}catch(std::exception&e){fail(p,e.what());return;}
+            p.phase=Pending::DONE;
         }
-        return "null";
-    }
-    static void skipJsonWs(const std::string& s,size_t& p){while(p<s.size()&&std::isspace(s[p]))p++;}
-    ValuePtr jsonToIron(const std::string& s,size_t& p){
-        skipJsonWs(s,p);
-        if(p>=s.size())return IronValue::makeNull();
-        char c=s[p];
-        if(c=='"'){
-            p++;std::string out;
-            while(p<s.size()&&s[p]!='"'){
-                if(s[p]=='\\'&&p+1<s.size()){p++;switch(s[p]){case'n':out+='\n';break;case't':out+='\t';break;default:out+=s[p];}}
-                else out+=s[p];p++;
+        // The server dropped an idle pooled socket: go again on a fresh connection
+        void retry(int id,Pending& p){unwatch(p);p.retried=true;restarts.push_back(id);}
+        void step(int id,Pending& p,bool readable,bool writable){
+            if(p.phase==Pending::CONNECTING){
+                if(!writable)return;
+                int err=0;socklen_t len=sizeof(err);
+                getsockopt(p.fd,SOL_SOCKET,SO_ERROR,(char*)&err,&len);
+                if(err!=0){fail(p,"Can't connect to "+p.url.host+":"+std::to_string(p.url.port));return;}
+                p.phase=Pending::SENDING;
+            }
+            if(p.phase==Pending::SENDING){
+                if(!writable)return;
+                while(p.sent<p.out.size()){
+                    ssize_t n=send(p.fd,p.out.c_str()+p.sent,p.out.size()-p.sent,MSG_NOSIGNAL);
+                    if(n<0&&wouldBlock())return;
+                    if(n<=0){
+                        if(p.reused&&!p.retried){retry(id,p);return;}
+                        fail(p,"Send failed");return;
+                    }
+                    p.sent+=n;
+                }
+                p.phase=Pending::RECEIVING;
+                watch(p.fd,false,true);
+                return;
+            }
+            if(p.phase==Pending::RECEIVING&&readable){
+                char buf[16384];
+                try{
+                    while(true){
+                        ssize_t n=recv(p.fd,buf,sizeof(buf),0);
+                        if(n>0){
+                            p.parser.feed(buf,n);
+                            if(p.parser.done()){finish(id,p);return;}
+                            continue;
+                        }
+                        if(n<0&&wouldBlock())return;
+                        if(!p.parser.started()&&p.reused&&!p.retried){retry(id,p);return;}
+                        p.parser.finishEof();  // peer closed: a close-delimited body is now complete (else this throws)
+                        finish(id,p);
+                        return;
+                    }
+                }catch(std::exception&e){fail(p,e.what());}
             }
-            if(p<s.size())p++;
-            return IronValue::makeStr(out);
         }
-        if(c=='['){
-            p++;auto arr=std::make_shared<IronArray>();skipJsonWs(s,p);
-            while(p<s.size()&&s[p]!=']'){
-                arr->push_back(jsonToIron(s,p));skipJsonWs(s,p);
-                if(p<s.size()&&s[p]==',')p++;
+        void pollOnce(const Deadline& dl){
+#ifdef __linux__
+            epoll_event evs[64];
+            int n=epoll_wait(epfd,evs,64,dl.waitMs());
+            if(n==0)throw TimedOut{};
+            for(int i=0;i<n;i++){
+                auto it=byFd.find(evs[i].data.fd);if(it==byFd.end())continue;
+                bool err=evs[i].events&(EPOLLERR|EPOLLHUP);
+                step(it->second,pending[it->second],(evs[i].events&EPOLLIN)||err,(evs[i].events&EPOLLOUT)||err);
             }
-            if(p<s.size())p++;return IronValue::makeArr(arr);
+#else
+            std::vector<pollfd> fds;
+            for(auto&[fd,id]:byFd){
+                pollfd pf{};pf.fd=fd;pf.events=pending[id].phase==Pending::RECEIVING?POLLIN:POLLOUT;
+                fds.push_back(pf);
+            }
+            if(!fds.empty()&&poll(fds.data(),fds.size(),dl.waitMs())==0)throw TimedOut{};
+            for(auto&pf:fds){
+                auto it=byFd.find(pf.fd);if(it==byFd.end()||!pf.revents)continue;
+                bool err=pf.revents&(POLLERR|POLLHUP);
+                step(it->second,pending[it->second],(pf.revents&POLLIN)||err,(pf.revents&POLLOUT)||err);
+            }
+#endif
+            // sockets closed in this batch may already be reused — start follow-ups only now
+            for(int id:restarts)begin(id,pending[id]);
+            restarts.clear();
         }
-        if(c=='{'){
-            p++;auto obj=std::make_shared<IronObject>();skipJsonWs(s,p);
-            while(p<s.size()&&s[p]!='}'){
-                size_t kp=p;auto key=jsonToIron(s,kp);p=kp;skipJsonWs(s,p);
-                if(p<s.size()&&s[p]==':')p++;
-                (*obj)[key->toString()]=jsonToIron(s,p);skipJsonWs(s,p);
-                if(p<s.size()&&s[p]==',')p++;
+    public:
+        HttpReactor(HttpPool& p):pool(p){
+#ifdef __linux__
+            epfd=epoll_create1(EPOLL_CLOEXEC);
+            if(epfd<0)throw std::runtime_error("Can't create event loop");
+#endif
+        }
+        ~HttpReactor(){
+            for(auto&[id,p]:pending)if(p.fd>=0)close(p.fd);
+#ifdef __linux__
+            close(epfd);
+#endif
+        }
+        int start(const std::string& method,const std::string& url,const std::string& body,
+                  const std::unordered_map<std::string,std::string>& headers,const std::string& toFile=""){
+            int id=nextId++;
+            Pending& p=pending[id];
+            p.method=method;p.body=body;p.headers=headers;p.toFile=toFile;
+            try{
+                p.url=parseUrl(url);
+                if(!toFile.empty()){
+                    p.file=std::make_unique<std::ofstream>(toFile,std::ios::binary);
+                    if(!*p.file)throw std::runtime_error("Can't write to file: "+toFile);
+                }
+            }catch(std::exception&e){fail(p,e.what());return id;}
+            begin(id,p);
+            return id;
+        }
+        bool done(int id){auto it=pending.find(id);return it==pending.end()||it->second.phase==Pending::DONE;}
+        // pump the loop until every one of ids is done; throws TimedOut at the deadline
+        void wait(const std::vector<int>& ids,const Deadline& dl){
+            while(true){
+                bool all=true;
+                for(int id:ids)if(!done(id)){all=false;break;}
+                if(all)return;
+                pollOnce(dl);
             }
-            if(p<s.size())p++;return IronValue::makeObj(obj);
         }
-        if(s.substr(p,4)=="null"){p+=4;return IronValue::makeNull();}
-        if(s.substr(p,4)=="true"){p+=4;return IronValue::makeBool(true);}
-        if(s.substr(p,5)=="false"){p+=5;return IronValue::makeBool(false);}
-        // number
-        size_t start=p;if(s[p]=='-')p++;
-        while(p<s.size()&&(std::isdigit(s[p])||s[p]=='.'||s[p]=='e'||s[p]=='E'||s[p]=='+'||s[p]=='-'))p++;
-        try{return IronValue::makeNum(std::stod(s.substr(start,p-start)));}catch(...){return IronValue::makeNull();}
-    }
-
-    ValuePtr callValue(ValuePtr callee,std::vector<ValuePtr> args){
-        if(auto*f=std::get_if<NativeFunc>(&callee->data))return (*f)(args);
-        if(auto*f=std::get_if<IronFunc>(&callee->data)){
-            Env fe;fe.parent=f->closure;
-            for(size_t i=0;i<f->params.size();i++)fe.define(f->params[i],i<args.size()?args[i]:IronValue::makeNull());
-            try{execBlock(*f->body,fe);}catch(ReturnSignal&r){return r.value;}
-            return IronValue::makeNull();
+        // Remove a finished request; returns its response, or throws its error
+        HttpResponse take(int id){
+            auto it=pending.find(id);
+            if(it==pending.end())throw std::runtime_error("Unknown fetch handle");
+            Pending p=std::move(it->second);pending.erase(it);
+            if(!p.error.empty())throw std::runtime_error(p.error);
+            return std::move(p.resp);
         }
-        throw std::runtime_error("That's not a function — can't call it.");
-    }
+    };
 
-    void assignLvalue(const Expr& target,ValuePtr val,Env& env){
-        std::visit([&](auto& node){
-            using T=std::decay_t<decltype(node)>;
-            if constexpr(std::is_same_v<T,VarExpr>) env.assign(node.name,val);
-            else if constexpr(std::is_same_v<T,IndexExpr>){
-                auto obj=evalExpr(*node.obj,env);auto idx=evalExpr(*node.index,env);
-                if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&obj->data))if(auto*n=std::get_if<double>(&idx->data))(**ap)[(int)*n]=val;
-                if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&obj->data))(**op)[idx->toString()]=val;
+    // ================================================================
+    //  v3.2 — HTTP server ('serve on port N with handler')
+    //  One event loop per process (epoll; poll elsewhere) accepts
+    //  connections and reads them without blocking. Requests are parsed
+    //  as their bytes arrive, several may be pipelined on a connection,
+    //  and a connection stays open for the next one unless the client
+    //  asks to close it. The handler runs on the interpreter thread, one
+    //  request at a time; {workers: N} forks N-1 more processes. On
+    //  Linux each has its own SO_REUSEPORT socket, so the kernel spreads
+    //  connections over them; elsewhere they share one.
+    // ================================================================
+    struct HttpStatusError { int status; std::string message; };  // a request that can't be served
+    class HttpRequestParser {
+    public:
+        struct Request {
+            std::string method,target,version,body;
+            std::unordered_map<std::string,std::string> headers;  // lowercased name → value
+            bool keepAlive{true};
+        };
+        static constexpr size_t MAX_HEAD=64*1024,MAX_BODY=64u<<20;
+        void feed(const char* d,size_t n){buf.append(d,n);}
+        // Take the next complete request out of the buffer (false: more bytes are needed)
+        bool next(Request& r){
+            if(!haveHead){
+                size_t skip=0;
+                while(skip<buf.size()&&(buf[skip]=='\r'||buf[skip]=='\n'))skip++;  // stray CRLF between requests
+                if(skip){buf.erase(0,skip);scanned=0;}
+                size_t end=buf.find("\r\n\r\n",scanned);
+                if(end==std::string::npos){
+                    if(buf.size()>MAX_HEAD)throw HttpStatusError{431,"Request headers too large"};
+                    scanned=buf.size()>3?buf.size()-3:0;
+                    return false;
+                }
+                parseHead(end);
             }
-            else if constexpr(std::is_same_v<T,MemberExpr>){
-                auto obj=evalExpr(*node.obj,env);
-                if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&obj->data))(**op)[node.field]=val;
+            if(buf.size()<headEnd+bodyLength)return false;
+            r=std::move(cur);cur=Request();
+            r.body.assign(buf,headEnd,bodyLength);
+            buf.erase(0,headEnd+bodyLength);
+            haveHead=false;scanned=0;continueDue=false;  // the body came anyway: no 100 for it
+            return true;
+        }
+        // true once per request whose client waits for "100 Continue" before sending the body,
+        // and only while that body is still to come
+        bool takeContinue(){bool c=continueDue&&haveHead&&buf.size()<headEnd+bodyLength;continueDue=false;return c;}
+    private:
+        std::string buf;           // received and not yet taken
+        size_t scanned{0};         // where the search for the blank line resumes
+        bool haveHead{false},continueDue{false};
+        size_t headEnd{0},bodyLength{0};
+        Request cur;
+        void parseHead(size_t end){
+            size_t eol=buf.find("\r\n");
+            size_t sp1=buf.find(' '),sp2=buf.rfind(' ',eol);
+            if(sp1>=eol||sp2==sp1)throw HttpStatusError{400,"Bad request line"};
+            cur.method=buf.substr(0,sp1);cur.target=buf.substr(sp1+1,sp2-sp1-1);cur.version=buf.substr(sp2+1,eol-sp2-1);
+            if(cur.version.compare(0,5,"HTTP/")!=0)throw HttpStatusError{400,"Bad request line"};
+            for(size_t p=eol+2;p<end;){
+                size_t e=buf.find("\r\n",p),c=buf.find(':',p);
+                if(c<e){
+                    std::string name=buf.substr(p,c-p);
+                    for(auto&ch:name)ch=::tolower(ch);
+                    size_t vs=buf.find_first_not_of(" \t",c+1),ve=e;
+                    while(ve>vs&&(buf[ve-1]==' '||buf[ve-1]=='\t'))ve--;
+                    cur.headers[name]=vs<ve?buf.substr(vs,ve-vs):"";
+                }
+                p=e+2;
             }
-        },target.node);
+            auto header=[&](const char* name){auto it=cur.headers.find(name);return it==cur.headers.end()?std::string():it->second;};
+            std::string conn=header("connection");for(auto&ch:conn)ch=::tolower(ch);
+            cur.keepAlive=cur.version=="HTTP/1.1"?conn.find("close")==std::string::npos:conn.find("keep-alive")!=std::string::npos;
+            if(!header("transfer-encoding").empty())throw HttpStatusError{411,"Send the body with a Content-Length"};
+            std::string length=header("content-length");
+            bodyLength=length.empty()?0:std::strtoull(length.c_str(),nullptr,10);
+            if(bodyLength>MAX_BODY)throw HttpStatusError{413,"Request body too large"};
+            continueDue=bodyLength&&header("expect")=="100-continue";
+            headEnd=end+4;haveHead=true;
+        }
+    };
+    static const char* httpReason(int status){
+        switch(status){
+            case 200:return "OK";case 201:return "Created";case 202:return "Accepted";case 204:return "No Content";
+            case 301:return "Moved Permanently";case 302:return "Found";case 304:return "Not Modified";
+            case 400:return "Bad Request";case 401:return "Unauthorized";case 403:return "Forbidden";case 404:return "Not Found";
+            case 405:return "Method Not Allowed";case 409:return "Conflict";case 411:return "Length Required";
+            case 413:return "Payload Too Large";case 422:return "Unprocessable Entity";case 429:return "Too Many Requests";
+            case 431:return "Request Header Fields Too Large";case 500:return "Internal Server Error";
+            case 501:return "Not Implemented";case 503:return "Service Unavailable";
+            default:return status<400?"OK":status<500?"Client Error":"Server Error";
+        }
     }
-
-    // ---- Execute statement ----
-    void execStmt(const Stmt& stmt,Env& env){
-        std::visit([&](auto& node){
-            using T=std::decay_t<decltype(node)>;
-
-            if constexpr(std::is_same_v<T,LetStmt>) env.define(node.name,evalExpr(*node.init,env));
-            else if constexpr(std::is_same_v<T,SetStmt>){auto val=evalExpr(*node.value,env);assignLvalue(*node.target,val,env);}
-            else if constexpr(std::is_same_v<T,AddToStmt>){
-                auto val=evalExpr(*node.value,env);
-                auto av=evalExpr(*node.target,env);
-                if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&av->data))(*ap)->push_back(val);
-                else throw std::runtime_error("Can't add to that — it's not a list.");
-            }
-            else if constexpr(std::is_same_v<T,SayStmt>) std::cout<<evalExpr(*node.expr,env)->toString()<<"\n";
-            else if constexpr(std::is_same_v<T,AskStmt>){
-                std::string prompt=evalExpr(*node.prompt,env)->toString();
-                if(!prompt.empty())std::cout<<prompt<<" ";
-                std::string input;std::getline(std::cin,input);
-                try{env.assign(node.varName,IronValue::makeStr(input));}catch(...){env.define(node.varName,IronValue::makeStr(input));}
+    static std::string httpResponse(int status,const std::string& body,const std::string& type,
+                                    const std::vector<std::pair<std::string,std::string>>& headers,bool keepAlive,bool head){
+        bool noBody=status==204||status==304||status/100==1;
+        std::string r="HTTP/1.1 "+std::to_string(status)+" "+httpReason(status)+"\r\n";
+        if(!noBody)r+="Content-Type: "+type+"\r\nContent-Length: "+std::to_string(body.size())+"\r\n";
+        for(auto&[k,v]:headers)r+=k+": "+v+"\r\n";
+        r+=keepAlive?"Connection: keep-alive\r\n\r\n":"Connection: close\r\n\r\n";
+        if(!noBody&&!head)r+=body;
+        return r;
+    }
+    static std::string urlDecode(const std::string& s,bool plusIsSpace){
+        std::string out;out.reserve(s.size());
+        for(size_t i=0;i<s.size();i++){
+            if(s[i]=='%'&&i+2<s.size()&&std::isxdigit((unsigned char)s[i+1])&&std::isxdigit((unsigned char)s[i+2])){
+                out+=(char)std::stoi(s.substr(i+1,2),nullptr,16);i+=2;
             }
-            else if constexpr(std::is_same_v<T,PauseStmt>){
-                std::cout<<"[Press Enter to continue...]";
-                std::cin.ignore(std::numeric_limits<std::streamsize>::max(),'\n');
+            else out+=plusIsSpace&&s[i]=='+'?' ':s[i];
+        }
+        return out;
+    }
+    // Call the handler with {method, path, query, headers, body}; its answer becomes the response.
+    // A dict is {status, body, headers}; a string is a 200 text body; null is 204; anything else
+    // (and a non-string body) is sent as JSON. An error in the handler is a 500.
+    std::string answerHttp(const ValuePtr& handler,HttpRequestParser::Request& r){
+        auto req=makePooled<IronObject>(),query=makePooled<IronObject>(),headers=makePooled<IronObject>();
+        size_t q=r.target.find('?');
+        (*req)["method"]=IronValue::makeStr(r.method);
+        (*req)["path"]=IronValue::makeStr(urlDecode(r.target.substr(0,q),false));
+        for(size_t p=q;p!=std::string::npos&&p<r.target.size();){
+            size_t amp=r.target.find('&',p+1);
+            std::string pair=r.target.substr(p+1,amp==std::string::npos?std::string::npos:amp-p-1);
+            size_t eq=pair.find('=');
+            if(!pair.empty())(*query)[urlDecode(pair.substr(0,eq),true)]=IronValue::makeStr(eq==std::string::npos?"":urlDecode(pair.substr(eq+1),true));
+            p=amp;
+        }
+        (*req)["query"]=IronValue::makeObj(query);
+        for(auto&[k,v]:r.headers)(*headers)[k]=IronValue::makeStr(v);
+        (*req)["headers"]=IronValue::makeObj(headers);
+        (*req)["body"]=IronValue::makeStr(std::move(r.body));
+        int status=200;
+        std::string body,type="text/plain; charset=utf-8";
+        std::vector<std::pair<std::string,std::string>> extra;
+        auto setBody=[&](const ValuePtr& v){
+            if(auto*s=std::get_if<std::string>(&v->data))body=*s;
+            else if(!std::holds_alternative<std::nullptr_t>(v->data)){body=ironToJson(v);type="application/json";}
+        };
+        auto clean=[](std::string s){s.erase(std::remove_if(s.begin(),s.end(),[](char c){return c=='\r'||c=='\n';}),s.end());return s;};
+        try{
+            ValuePtr res=callValue(handler,{IronValue::makeObj(req)});
+            if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&res->data)){
+                auto& o=**op;
+                auto st=o.find("status");
+                if(st!=o.end())if(auto*n=std::get_if<double>(&st->second->data))status=std::max(100,std::min(599,(int)*n));
+                auto b=o.find("body");
+                if(b!=o.end())setBody(b->second);
+                auto h=o.find("headers");
+                if(h!=o.end())if(auto*hp=std::get_if<std::shared_ptr<IronObject>>(&h->second->data))
+                    for(auto&[k,v]:**hp){
+                        std::string name=clean(k),lower=name;
+                        for(auto&ch:lower)ch=::tolower(ch);
+                        if(lower=="content-type")type=clean(v->toString());
+                        else if(lower!="content-length"&&lower!="connection")extra.emplace_back(name,clean(v->toString()));
+                    }
             }
-            else if constexpr(std::is_same_v<T,IfStmt>){
-                Env ie;ie.parent=&env;
-                if(evalExpr(*node.cond,env)->isTruthy())execBlock(node.thenBody,ie);
-                else execBlock(node.elseBody,ie);
+            else if(std::holds_alternative<std::nullptr_t>(res->data))status=204;
+            else setBody(res);
+        }catch(const ThrowSignal&t){
+            std::cerr<<"serve: "<<r.method<<" "<<r.target<<": "<<t.message<<"\n";
+            status=500;body=t.message+"\n";type="text/plain; charset=utf-8";extra.clear();
+        }catch(const std::exception&e){
+            std::cerr<<"serve: "<<r.method<<" "<<r.target<<": "<<e.what()<<"\n";
+            status=500;body=std::string(e.what())+"\n";type="text/plain; charset=utf-8";extra.clear();
+        }
+        return httpResponse(status,body,type,extra,r.keepAlive,r.method=="HEAD");
+    }
+    static int listenOn(const std::string& host,int port,bool sharePort=false){
+        addrinfo hints{},*res=nullptr;
+        hints.ai_family=AF_UNSPEC;hints.ai_socktype=SOCK_STREAM;hints.ai_flags=AI_PASSIVE;
+        std::string ps=std::to_string(port);
+        if(getaddrinfo(host.c_str(),ps.c_str(),&hints,&res)!=0||!res)throw std::runtime_error("serve: unknown host "+host);
+        int fd=openSocket(res->ai_family,res->ai_socktype,res->ai_protocol);
+        int one=1;
+        if(fd>=0)setsockopt(fd,SOL_SOCKET,SO_REUSEADDR,(const char*)&one,sizeof one);
+#ifdef SO_REUSEPORT
+        if(fd>=0&&sharePort)setsockopt(fd,SOL_SOCKET,SO_REUSEPORT,(const char*)&one,sizeof one);
+#else
+        (void)sharePort;
+#endif
+        bool ok=fd>=0&&bind(fd,res->ai_addr,(int)res->ai_addrlen)==0&&listen(fd,SOMAXCONN)==0;
+        freeaddrinfo(res);
+        if(!ok){
+            std::string why=std::strerror(errno);
+            if(fd>=0)close(fd);
+            throw std::runtime_error("serve: can't listen on "+host+":"+ps+" ("+why+")");
+        }
+        setNonBlocking(fd);
+        return fd;
+    }
+    static int boundPort(int fd){
+        sockaddr_storage a{};socklen_t n=sizeof a;
+        getsockname(fd,(sockaddr*)&a,&n);
+        return ntohs(a.ss_family==AF_INET6?((sockaddr_in6*)&a)->sin6_port:((sockaddr_in*)&a)->sin_port);
+    }
+    class HttpServer {
+        struct Conn { HttpRequestParser parser; std::string out; size_t sent{0}; bool closing{false},writing{false}; };
+        Interpreter& in;
+        ValuePtr handler;
+        int listener;
+        std::unordered_map<int,Conn> conns;
+#ifdef __linux__
+        int epfd{-1};
+#endif
+        void watch(int fd,bool wantWrite,bool added){
+#ifdef __linux__
+            epoll_event ev{};ev.events=wantWrite?EPOLLOUT:EPOLLIN;ev.data.fd=fd;
+            epoll_ctl(epfd,added?EPOLL_CTL_MOD:EPOLL_CTL_ADD,fd,&ev);
+#else
+            (void)fd;(void)wantWrite;(void)added;  // poll() rebuilds its set from each connection's state
+#endif
+        }
+        void drop(int fd){
+#ifdef __linux__
+            epoll_ctl(epfd,EPOLL_CTL_DEL,fd,nullptr);
+#endif
+            close(fd);conns.erase(fd);
+        }
+        void acceptAll(){
+            for(;;){
+                int fd=acceptSocket(listener);
+                if(fd<0)return;  // none left (or one that died while queued)
+                setNonBlocking(fd);
+                int one=1;setsockopt(fd,IPPROTO_TCP,TCP_NODELAY,(const char*)&one,sizeof one);
+                conns[fd];watch(fd,false,false);
+            }
+        }
+        void readable(int fd,Conn& c){
+            char buf[16384];
+            bool eof=false;
+            for(;;){
+                ssize_t n=recv(fd,buf,sizeof buf,0);
+                if(n>0){c.parser.feed(buf,n);continue;}
+                eof=n==0||!wouldBlock();
+                break;
+            }
+            HttpRequestParser::Request r;
+            try{
+                while(!c.closing&&c.parser.next(r)){
+                    c.out+=in.answerHttp(handler,r);
+                    if(!r.keepAlive)c.closing=true;
+                }
+                // after the responses above: a 100 belongs to the request still waiting for its body
+                if(!c.closing&&c.parser.takeContinue())c.out+="HTTP/1.1 100 Continue\r\n\r\n";
+            }catch(const HttpStatusError&e){
+                c.out+=httpResponse(e.status,e.message+"\n","text/plain; charset=utf-8",{},false,false);
+                c.closing=true;
+            }
+            if(eof)c.closing=true;  // the client is done sending: answer what it asked, then close
+            flush(fd,c);
+        }
+        void flush(int fd,Conn& c){
+            while(c.sent<c.out.size()){
+                ssize_t n=send(fd,c.out.data()+c.sent,c.out.size()-c.sent,MSG_NOSIGNAL);
+                if(n<0&&wouldBlock()){if(!c.writing){c.writing=true;watch(fd,true,true);}return;}
+                if(n<=0){drop(fd);return;}
+                c.sent+=n;
+            }
+            c.out.clear();c.sent=0;
+            if(c.closing){drop(fd);return;}
+            if(c.writing){c.writing=false;watch(fd,false,true);}  // read again once the answers are out
+        }
+        void event(int fd,bool readReady,bool writeReady,bool failed){
+            if(fd==listener){acceptAll();return;}
+            auto it=conns.find(fd);
+            if(it==conns.end())return;
+            Conn& c=it->second;
+            if(c.writing){if(writeReady||failed)flush(fd,c);return;}
+            if(readReady||failed)readable(fd,c);
+        }
+    public:
+        HttpServer(Interpreter& in,ValuePtr handler,int listener):in(in),handler(std::move(handler)),listener(listener){
+#ifdef __linux__
+            epfd=epoll_create1(EPOLL_CLOEXEC);
+            if(epfd<0)throw std::runtime_error("Can't create event loop");
+            epoll_event ev{};ev.events=EPOLLIN;ev.data.fd=listener;
+#  ifdef EPOLLEXCLUSIVE
+            ev.events|=EPOLLEXCLUSIVE;  // with workers, one process wakes per new connection
+#  endif
+            epoll_ctl(epfd,EPOLL_CTL_ADD,listener,&ev);
+#endif
+        }
+        ~HttpServer(){
+            for(auto&[fd,c]:conns)close(fd);
+#ifdef __linux__
+            close(epfd);
+#endif
+        }
+        // serves until the handler raises something that isn't answered with a 500 (a limit)
+        void run(){
+            for(;;){
+#ifdef __linux__
+                epoll_event evs[256];
+                int n=epoll_wait(epfd,evs,256,-1);
+                for(int i=0;i<n;i++){
+                    bool failed=evs[i].events&(EPOLLERR|EPOLLHUP);
+                    event(evs[i].data.fd,evs[i].events&EPOLLIN,evs[i].events&EPOLLOUT,failed);
+                }
+#else
+                std::vector<pollfd> fds;
+                pollfd lp{};lp.fd=listener;lp.events=POLLIN;fds.push_back(lp);
+                for(auto&[fd,c]:conns){pollfd pf{};pf.fd=fd;pf.events=c.writing?POLLOUT:POLLIN;fds.push_back(pf);}
+                poll(fds.data(),fds.size(),-1);
+                for(auto&pf:fds)if(pf.revents)event((int)pf.fd,pf.revents&POLLIN,pf.revents&POLLOUT,pf.revents&(POLLERR|POLLHUP));
+#endif
+            }
+        }
+    };
+    void execServe(const ServeStmt& node,Env& env){
+        auto portV=evalExpr(*node.port,env);
+        auto* port=std::get_if<double>(&portV->data);
+        if(!port||*port<0||*port>65535||*port!=std::floor(*port))throw std::runtime_error("serve: the port must be a number from 0 to 65535");
+        ValuePtr handler=evalExpr(*node.handler,env);
+        std::string host="0.0.0.0";
+        size_t workers=1;
+        if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&handler->data)){
+            auto opts=*op;  // {handler, workers, host}
+            auto opt=[&](const char* k)->ValuePtr{auto it=opts->find(k);return it==opts->end()?nullptr:it->second;};
+            if(auto h=opt("host"))host=h->toString();
+            if(auto w=opt("workers")){
+                auto* n=std::get_if<double>(&w->data);
+                if(!n||*n<1||*n>1024)throw std::runtime_error("serve: workers must be a number from 1 to 1024");
+                workers=(size_t)*n;
+                if(workers>1&&!ownsProcess)
+                    throw std::runtime_error("serve: workers only work when the script is run by the ironwood command itself (not embedded or under --serve)");
+            }
+            handler=opt("handler");
+            if(!handler)throw std::runtime_error("serve: the options need a handler, like {handler: handle, workers: 4}");
+        }
+        if(!std::holds_alternative<IronFunc>(handler->data)&&!std::holds_alternative<NativeFunc>(handler->data))
+            throw std::runtime_error("serve: the handler must be a function, like function(req) ... end");
+        // on Linux, SO_REUSEPORT lets each worker have its own socket on the port
+#ifdef __linux__
+        bool ownSockets=workers>1;
+#else
+        bool ownSockets=false;
+#endif
+        int listener=listenOn(host,(int)*port,ownSockets);
+        int bound=boundPort(listener);
+        std::cerr<<"Serving http://"<<host<<":"<<bound<<(workers>1?" with "+std::to_string(workers)+" worker processes":"")<<"\n";
+#ifdef _WIN32
+        struct Close{int fd;~Close(){close(fd);}} closeListener{listener};
+        if(workers>1)throw std::runtime_error("serve: workers need fork() (Linux / macOS)");
+#else
+        // workers are copies of this process, made now, so each has the handler and everything it uses
+        out->flush();std::cerr.flush();
+        std::vector<pid_t> children;
+        for(size_t i=1;i<workers;i++){
+            pid_t pid=fork();
+            if(pid<0)break;
+            if(pid>0){children.push_back(pid);continue;}
+#  ifdef __linux__
+            prctl(PR_SET_PDEATHSIG,SIGTERM);  // go when the first process goes
+#  endif
+            std::string error;
+            try{
+                if(ownSockets){close(listener);listener=listenOn(host,bound,true);}
+                HttpServer(*this,handler,listener).run();
+            }
+            catch(const ThrowSignal&t){error=t.message;}
+            catch(const LimitSignal&l){error=l.message;}
+            catch(const std::exception&e){error=e.what();}
+            out->flush();
+            std::cerr<<"\n--- Ironwood Error ---\n"<<error<<"\n";
+            _exit(1);  // never back into the script: only the first process carries on
+        }
+        struct Stop{std::vector<pid_t>& pids;int fd;~Stop(){for(pid_t p:pids){kill(p,SIGTERM);waitpid(p,nullptr,0);}close(fd);}} stop{children,listener};
+#endif
+        HttpServer(*this,handler,listener).run();
+    }
+
+    // ================================================================
+    //  v3.2 — Subprocess via posix_spawn (popen on Windows)
+    //  A string command goes through /bin/sh with stderr merged into the
+    //  output, as before; a list is an argv run directly, no shell, with
+    //  stderr kept separate. Output is read in 64 KiB blocks while stdin
+    //  input is fed and stderr drained, so neither pipe can deadlock.
+    // ================================================================
+    class Subprocess {
+    public:
+        enum ErrMode{MERGE,CAPTURE,INHERIT};
+        std::string err;  // collected stderr (CAPTURE)
+    private:
+        static constexpr size_t BLOCK=64*1024;
+        std::string input;size_t inPos{0};
+#ifdef _WIN32
+        FILE* pipe{nullptr};
+#else
+        pid_t pid{-1};
+        bool killed{false};
+        int inFd{-1},outFd{-1},errFd{-1};
+        static void closeFd(int& fd){if(fd>=0){close(fd);fd=-1;}}
+#endif
+        int code{-1};
+    public:
+        Subprocess(const std::vector<std::string>& argv,bool shell,ErrMode errMode,std::string stdinData=""):input(std::move(stdinData)){
+            if(argv.empty())throw std::runtime_error("Can't run an empty command");
+#ifdef _WIN32
+            if(!input.empty())throw std::runtime_error("'input' for run isn't supported on Windows");
+            std::string cmd;
+            for(auto&a:argv){
+                if(!cmd.empty())cmd+=" ";
+                cmd+=shell||a.find_first_of(" \t\"")==std::string::npos?a:"\""+a+"\"";
+            }
+            if(errMode==MERGE)cmd+=" 2>&1";
+            pipe=popen(cmd.c_str(),"r");
+            if(!pipe)throw std::runtime_error("Can't run command: "+cmd);
+#else
+            int in[2]={-1,-1},out[2],er[2]={-1,-1};
+            if(openPipe(out)<0)throw std::runtime_error("Can't create pipe");
+            if(!input.empty()&&openPipe(in)<0){close(out[0]);close(out[1]);throw std::runtime_error("Can't create pipe");}
+            if(errMode==CAPTURE&&openPipe(er)<0){close(out[0]);close(out[1]);if(in[0]>=0){close(in[0]);close(in[1]);}throw std::runtime_error("Can't create pipe");}
+            posix_spawn_file_actions_t fa;posix_spawn_file_actions_init(&fa);
+            if(in[0]>=0){posix_spawn_file_actions_adddup2(&fa,in[0],0);posix_spawn_file_actions_addclose(&fa,in[1]);}
+            posix_spawn_file_actions_adddup2(&fa,out[1],1);
+            posix_spawn_file_actions_addclose(&fa,out[0]);
+            if(errMode==MERGE)posix_spawn_file_actions_adddup2(&fa,out[1],2);
+            if(errMode==CAPTURE){posix_spawn_file_actions_adddup2(&fa,er[1],2);posix_spawn_file_actions_addclose(&fa,er[0]);}
+            // the interpreter ignores SIGPIPE; children get the default back
+            posix_spawnattr_t attr;posix_spawnattr_init(&attr);
+            sigset_t def;sigemptyset(&def);sigaddset(&def,SIGPIPE);
+            posix_spawnattr_setsigdefault(&attr,&def);
+            posix_spawnattr_setflags(&attr,POSIX_SPAWN_SETSIGDEF);
+            std::vector<std::string> args=shell?std::vector<std::string>{"/bin/sh","-c",argv[0]}:argv;
+            std::vector<char*> cargv;
+            for(auto&a:args)cargv.push_back(const_cast<char*>(a.c_str()));
+            cargv.push_back(nullptr);
+            int rc=posix_spawnp(&pid,cargv[0],&fa,&attr,cargv.data(),environ);
+            posix_spawn_file_actions_destroy(&fa);posix_spawnattr_destroy(&attr);
+            close(out[1]);if(in[0]>=0)close(in[0]);if(er[1]>=0)close(er[1]);
+            outFd=out[0];inFd=in[1];errFd=er[0];
+            if(rc!=0){
+                closeFd(outFd);closeFd(inFd);closeFd(errFd);pid=-1;
+                throw std::runtime_error("Can't run command: "+argv[0]+" ("+std::strerror(rc)+")");
+            }
+            if(inFd>=0)fcntl(inFd,F_SETFL,fcntl(inFd,F_GETFL,0)|O_NONBLOCK);
+#endif
+        }
+        Subprocess(const Subprocess&)=delete;
+        Subprocess& operator=(const Subprocess&)=delete;
+        ~Subprocess(){if(code<0){kill();wait();}}
+
+#ifndef _WIN32
+        // Add this child's open pipes to a poll set (so many children can share one poll)
+        void pollFds(std::vector<pollfd>& fds) const {
+            if(outFd>=0)fds.push_back({outFd,POLLIN,0});
+            if(errFd>=0)fds.push_back({errFd,POLLIN,0});
+            if(inFd>=0) fds.push_back({inFd,POLLOUT,0});
+        }
+        bool owns(int fd) const {return fd>=0&&(fd==outFd||fd==errFd||fd==inFd);}
+        // Service one ready pipe; stdout bytes are appended to `chunk`. Returns the byte count read from stdout.
+        size_t service(const pollfd& pf,std::string& chunk){
+            if(!pf.revents)return 0;
+            char buf[BLOCK];
+            if(pf.fd==inFd){
+                ssize_t n=write(inFd,input.data()+inPos,input.size()-inPos);
+                if(n>0)inPos+=n;
+                if(n<0&&errno!=EAGAIN)inPos=input.size();  // child closed its stdin
+                if(inPos>=input.size())closeFd(inFd);
+            } else if(pf.fd==errFd){
+                ssize_t n=::read(errFd,buf,sizeof(buf));
+                if(n>0)err.append(buf,n);else closeFd(errFd);
+            } else if(pf.fd==outFd){
+                ssize_t n=::read(outFd,buf,sizeof(buf));
+                if(n>0){chunk.append(buf,n);return n;}
+                closeFd(outFd);
+            }
+            return 0;
+        }
+#endif
+        bool running() const {
+#ifdef _WIN32
+            return pipe!=nullptr&&code<0;
+#else
+            return outFd>=0;
+#endif
+        }
+        // Next block of stdout appended to `chunk`; false once stdout is closed.
+        // Past the deadline the child is killed and this throws TimedOut.
+        bool read(std::string& chunk,const Deadline& dl){
+#ifdef _WIN32
+            (void)dl;  // fread on a popen pipe can't wait with a timeout
+            char buf[BLOCK];
+            size_t n=fread(buf,1,sizeof(buf),pipe);
+            if(n==0)return false;
+            chunk.append(buf,n);return true;
+#else
+            std::vector<pollfd> fds;
+            while(outFd>=0){
+                fds.clear();pollFds(fds);
+                int ready=poll(fds.data(),fds.size(),dl.waitMs());
+                if(ready<0){if(errno==EINTR)continue;return false;}
+                if(ready==0){kill(SIGKILL);throw TimedOut{};}
+                size_t got=0;
+                for(auto&pf:fds)got+=service(pf,chunk);
+                if(got)return true;
+            }
+            return false;
+#endif
+        }
+        // Reap the child (draining stderr first); returns its exit code, 128+signal if killed.
+        // A child still running at the deadline is killed and this throws TimedOut.
+        int wait(const Deadline& dl={}){
+            if(code>=0)return code;
+#ifdef _WIN32
+            (void)dl;
+            code=pipe?pclose(pipe):1;pipe=nullptr;
+#else
+            closeFd(inFd);closeFd(outFd);
+            bool late=false;
+            char buf[BLOCK];
+            // once killed, don't wait for stderr: a grandchild may hold it open
+            while(errFd>=0&&!killed){
+                pollfd pf{errFd,POLLIN,0};
+                int ready=poll(&pf,1,dl.waitMs());
+                if(ready<0&&errno==EINTR)continue;
+                if(ready==0){late=true;kill(SIGKILL);break;}
+                ssize_t n=::read(errFd,buf,sizeof(buf));
+                if(n<=0)break;
+                err.append(buf,n);
+            }
+            closeFd(errFd);
+            int status=0;
+            while(pid>0){
+                pid_t r=waitpid(pid,&status,dl.set&&!killed?WNOHANG:0);
+                if(r<0&&errno==EINTR)continue;
+                if(r!=0)break;
+                if(dl.passed()){late=true;kill(SIGKILL);continue;}  // stdout closed, but still running
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            }
+            code=WIFEXITED(status)?WEXITSTATUS(status):WIFSIGNALED(status)?128+WTERMSIG(status):1;
+            if(late)throw TimedOut{};
+#endif
+            return code;
+        }
+        // Stop the child early (e.g. 'break' out of 'for each line in run ...')
+        void kill(int sig=SIGTERM){
+#ifndef _WIN32
+            if(pid>0&&code<0){::kill(pid,sig);killed=true;}
+#else
+            (void)sig;
+#endif
+        }
+    };
+    // Command value → argv: a list runs directly, anything else is a shell command line
+    static std::vector<std::string> commandArgv(const ValuePtr& cmd,bool& shell){
+        shell=false;
+        std::vector<std::string> argv;
+        if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&cmd->data)){for(auto&a:**ap)argv.push_back(a->toString());return argv;}
+        shell=true;
+        return {cmd->toString()};
+    }
+    static ValuePtr runResult(std::string output,std::string error,int code){
+        auto obj=makePooled<IronObject>();
+        (*obj)["output"]=IronValue::makeStr(std::move(output));
+        (*obj)["error"] =IronValue::makeStr(std::move(error));
+        (*obj)["code"]  =IronValue::makeNum(code);
+        (*obj)["ok"]    =IronValue::makeBool(code==0);
+        return IronValue::makeObj(obj);
+    }
+    // v3.2: run all [cmds] — keep up to `parallel` children going at once; results in input order
+    static ValuePtr runAll(const IronArray& cmds,size_t parallel,const Deadline& dl){
+        IronArray results(cmds.size());
+        auto launch=[&](size_t i){
+            bool shell;auto argv=commandArgv(cmds[i],shell);
+            return std::make_unique<Subprocess>(argv,shell,shell?Subprocess::MERGE:Subprocess::CAPTURE);
+        };
+#ifdef _WIN32
+        (void)parallel;  // no poll() over popen pipes — one at a time
+        for(size_t i=0;i<cmds.size();i++){
+            try{auto p=launch(i);std::string out;while(p->read(out,dl)){}int code=p->wait(dl);results[i]=runResult(std::move(out),std::move(p->err),code);}
+            catch(std::exception&e){results[i]=runResult("",e.what(),127);}
+        }
+#else
+        struct Slot{size_t index;std::unique_ptr<Subprocess> proc;std::string out;};
+        std::vector<Slot> slots;
+        size_t next=0;
+        std::vector<pollfd> fds;
+        while(next<cmds.size()||!slots.empty()){
+            while(next<cmds.size()&&slots.size()<parallel){
+                size_t i=next++;
+                try{slots.push_back({i,launch(i),""});}
+                catch(std::exception&e){results[i]=runResult("",e.what(),127);}  // couldn't spawn: record, keep going
+            }
+            if(slots.empty())continue;
+            fds.clear();
+            for(auto&s:slots)s.proc->pollFds(fds);
+            int ready=poll(fds.data(),fds.size(),dl.waitMs());
+            if(ready<0&&errno!=EINTR)throw std::runtime_error("run all: poll failed");
+            if(ready==0){for(auto&sl:slots)sl.proc->kill(SIGKILL);throw TimedOut{};}
+            for(auto&pf:fds)for(auto&s:slots)if(s.proc->owns(pf.fd)){s.proc->service(pf,s.out);break;}
+            // reap children whose stdout has closed, freeing their slot
+            for(size_t k=0;k<slots.size();){
+                if(slots[k].proc->running()){k++;continue;}
+                int code=slots[k].proc->wait(dl);
+                results[slots[k].index]=runResult(std::move(slots[k].out),std::move(slots[k].proc->err),code);
+                slots.erase(slots.begin()+k);
+            }
+        }
+#endif
+        auto arr=makePooled<IronArray>(std::move(results));
+        return IronValue::makeArr(arr);
+    }
+    // run ... with {input: "..."}
+    std::string runInput(const RunExpr& node,Env& env){
+        if(!node.opts)return "";
+        auto opts=evalExpr(*node.opts,env);
+        if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&opts->data)){
+            auto it=(*op)->find("input");
+            if(it!=(*op)->end())return it->second->toString();
+        }
+        return "";
+    }
+
+    // ================================================================
+    //  v3.1 — Eval: FetchExpr + RunExpr
+    // ================================================================
+    ValuePtr evalFetch(const FetchExpr& node,Env& env,bool async=false){
+        auto urlVal=evalExpr(*node.url,env);
+        std::string method="GET",body;
+        std::unordered_map<std::string,std::string> headers;
+        if(node.opts){
+            auto opts=evalExpr(*node.opts,env);
+            if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&opts->data)){
+                auto get=[&](const std::string&k)->std::string{
+                    auto it=(*op)->find(k);return it!=(*op)->end()?it->second->toString():"";
+                };
+                if(auto m=get("method");!m.empty()){method=m;for(auto&c:method)c=::toupper(c);}
+                body=get("body");
+                // headers sub-dict
+                auto hit=(*op)->find("headers");
+                if(hit!=(*op)->end()){
+                    if(auto*hp=std::get_if<std::shared_ptr<IronObject>>(&hit->second->data))
+                        for(auto&[k,v]:**hp)headers[k]=v->toString();
+                }
+            }
+        }
+        std::string toFile=node.toFile?evalExpr(*node.toFile,env)->toString():"";
+        if(!toFile.empty()&&std::get_if<std::shared_ptr<IronArray>>(&urlVal->data))
+            throw std::runtime_error("'fetch ... to file' takes a single url, not a list");
+        if(async){
+            // one handle per url; a list of urls gives a list of handles
+            if(!reactor)reactor=std::make_unique<HttpReactor>(pool());
+            auto startOne=[&](const std::string& url){
+                auto h=makePooled<IronObject>();
+                (*h)["__fetch__"]=IronValue::makeNum(reactor->start(method,url,body,headers,toFile));
+                (*h)["url"]=IronValue::makeStr(url);
+                if(!toFile.empty())(*h)["path"]=IronValue::makeStr(toFile);
+                return IronValue::makeObj(h);
+            };
+            if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&urlVal->data)){
+                auto arr=makePooled<IronArray>();
+                for(auto&u:**ap)arr->push_back(startOne(u->toString()));
+                return IronValue::makeArr(arr);
+            }
+            return startOne(urlVal->toString());
+        }
+        try{
+            return fetchResult(blocking([&]{return httpRequest(pool(),deadline,method,urlVal->toString(),body,headers,toFile);}),toFile);
+        }catch(std::exception&e){
+            return fetchError(e.what());
+        }
+    }
+    HttpPool& pool(){if(!httpPool)httpPool=std::make_unique<HttpPool>();return *httpPool;}
+    static ValuePtr fetchResult(HttpResponse resp,const std::string& toFile=""){
+        auto obj=makePooled<IronObject>();
+        (*obj)["body"]  =IronValue::makeStr(std::move(resp.body));
+        if(!toFile.empty()){
+            (*obj)["path"] =IronValue::makeStr(toFile);
+            (*obj)["bytes"]=IronValue::makeNum((double)resp.bytes);
+        }
+        (*obj)["status"]=IronValue::makeNum(resp.status);
+        (*obj)["ok"]    =IronValue::makeBool(resp.status>=200&&resp.status<300);
+        return IronValue::makeObj(obj);
+    }
+    static ValuePtr fetchError(const std::string& msg){
+        auto obj=makePooled<IronObject>();
+        (*obj)["body"]  =IronValue::makeStr(msg);
+        (*obj)["status"]=IronValue::makeNum(0);
+        (*obj)["ok"]    =IronValue::makeBool(false);
+        return IronValue::makeObj(obj);
+    }
+    // v3.2: resolve a pending fetch handle (or every handle in a list) to {body, status, ok}
+    ValuePtr awaitValue(ValuePtr v){
+        auto handleId=[this](const ValuePtr& x)->int{
+            if(!reactor)return 0;
+            if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&x->data)){
+                auto it=(*op)->find("__fetch__");
+                if(it!=(*op)->end())if(auto*n=std::get_if<double>(&it->second->data))return (int)*n;
+            }
+            return 0;
+        };
+        auto resolve=[&](const ValuePtr& x)->ValuePtr{
+            int id=handleId(x);if(!id)return x;
+            auto& h=*std::get<std::shared_ptr<IronObject>>(x->data);
+            auto cached=h.find("__result__");
+            if(cached!=h.end())return cached->second;  // awaiting twice gives the same response
+            ValuePtr res;
+            auto path=h.find("path");
+            try{res=fetchResult(reactor->take(id),path!=h.end()?path->second->toString():"");}catch(std::exception&e){res=fetchError(e.what());}
+            h["__result__"]=res;
+            return res;
+        };
+        if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&v->data)){
+            std::vector<int> ids;
+            for(auto&x:**ap)if(int id=handleId(x))ids.push_back(id);
+            if(!ids.empty())blocking([&]{reactor->wait(ids,deadline);});
+            auto arr=makePooled<IronArray>();
+            for(auto&x:**ap)arr->push_back(resolve(x));
+            return IronValue::makeArr(arr);
+        }
+        if(int id=handleId(v))blocking([&]{reactor->wait({id},deadline);});
+        return resolve(v);
+    }
+    ValuePtr evalRun(const RunExpr& node,Env& env){
+        if(node.all){
+            auto list=evalExpr(*node.cmd,env);
+            auto*ap=std::get_if<std::shared_ptr<IronArray>>(&list->data);
+            if(!ap)throw std::runtime_error("'run all' expects a list of commands");
+            size_t parallel=std::max(1u,std::thread::hardware_concurrency());
+            if(node.opts){
+                auto opts=evalExpr(*node.opts,env);
+                if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&opts->data)){
+                    auto it=(*op)->find("parallel");
+                    if(it!=(*op)->end())if(auto*n=std::get_if<double>(&it->second->data)){
+                        if(std::isnan(*n))throw std::runtime_error("'run all': parallel must be a number, like {parallel: 4}");
+                        // clamped while still a double: converting inf or 1e30 to size_t is undefined
+                        parallel=(size_t)std::min(std::max(1.0,*n),(double)std::max<size_t>((*ap)->size(),1));
+                    }
+                }
+            }
+            parallel=std::min(parallel,std::max<size_t>((*ap)->size(),1));
+            return blocking([&]{return runAll(**ap,parallel,deadline);});
+        }
+        bool shell;
+        auto argv=commandArgv(evalExpr(*node.cmd,env),shell);
+        Subprocess proc(argv,shell,shell?Subprocess::MERGE:Subprocess::CAPTURE,runInput(node,env));
+        std::string output;
+        int code=blocking([&]{while(proc.read(output,deadline)){}return proc.wait(deadline);});
+        return runResult(std::move(output),std::move(proc.err),code);
+    }
+
+    // ---- v3.2 CSV: options and rows ----
+    void eachCsvRow(const CsvExpr& node,Env& env,const std::function<bool(ValuePtr)>& onRow){
+        auto src=evalExpr(*node.src,env)->toString();
+        char sep=',';bool header=false;
+        if(node.opts){
+            auto opts=evalExpr(*node.opts,env);
+            if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&opts->data)){
+                auto h=(*op)->find("header");if(h!=(*op)->end())header=h->second->isTruthy();
+                auto s=(*op)->find("separator");
+                if(s!=(*op)->end()){
+                    auto t=s->second->toString();
+                    if(t.size()!=1||t=="\""||t=="\n"||t=="\r")throw std::runtime_error("A CSV separator must be one character (not a quote or newline).");
+                    sep=t[0];
+                }
+            }
+        }
+        readCsv(src,node.file,sep,header,onRow);
+    }
+    // for each row in csv file "p" → records streamed as they are read
+    Flow forEachCsvRow(const ForStmt& node,const CsvExpr& ce,Env& env){
+        Env le;le.parent=&env;
+        ValuePtr& item=le.vars[node.var];
+        Flow out=Flow::NORMAL;
+        eachCsvRow(ce,env,[&](ValuePtr row){
+            freshIteration(le,&node.var);item=std::move(row);
+            Flow f=execBlock(node.body,le);
+            if(f==Flow::BREAK)return false;
+            if(leavesFunction(f)){out=f;return false;}
+            return true;
+        });
+        return out;
+    }
+
+    // ---- v3.1 JSON helpers ----
+    std::string ironToJson(ValuePtr v){
+        if(std::get_if<std::nullptr_t>(&v->data))return "null";
+        if(auto*b=std::get_if<bool>(&v->data))return *b?"true":"false";
+        if(auto*n=std::get_if<double>(&v->data)){
+            if(*n==std::floor(*n)&&std::abs(*n)<1e15)return std::to_string((long long)*n);
+            std::ostringstream o;o<<*n;return o.str();
+        }
+        if(auto*s=std::get_if<std::string>(&v->data)){
+            std::string out="\"";
+            for(char c:*s){if(c=='"')out+="\\\"";else if(c=='\\')out+="\\\\";else if(c=='\n')out+="\\n";else if(c=='\t')out+="\\t";else out+=c;}
+            return out+"\"";
+        }
+        if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&v->data)){
+            std::string out="[";
+            for(size_t i=0;i<(*ap)->size();i++){if(i)out+=",";out+=ironToJson((**ap)[i]);}
+            return out+"]";
+        }
+        if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&v->data)){
+            std::string out="{";bool first=true;
+            for(auto&[k,val]:**op){
+                if(k=="__class__")continue;
+                if(!first)out+=",";out+="\""+k+"\":"+ironToJson(val);first=false;
+            }
+            return out+"}";
+        }
+        return "null";
+    }
+    static void skipJsonWs(const std::string& s,size_t& p){while(p<s.size()&&std::isspace(s[p]))p++;}
+    ValuePtr jsonToIron(const std::string& s,size_t& p){
+        skipJsonWs(s,p);
+        if(p>=s.size())return IronValue::makeNull();
+        char c=s[p];
+        if(c=='"'){
+            p++;std::string out;
+            while(p<s.size()&&s[p]!='"'){
+                if(s[p]=='\\'&&p+1<s.size()){p++;switch(s[p]){case'n':out+='\n';break;case't':out+='\t';break;default:out+=s[p];}}
+                else out+=s[p];p++;
             }
-            else if constexpr(std::is_same_v<T,WhileStmt>){
-                while(evalExpr(*node.cond,env)->isTruthy()){
-                    Env le;le.parent=&env;
-                    try{execBlock(node.body,le);}catch(BreakSignal&){break;}catch(ContinueSignal&){continue;}
+            if(p<s.size())p++;
+            return IronValue::makeStr(out);
+        }
+        if(c=='['){
+            p++;auto arr=makePooled<IronArray>();skipJsonWs(s,p);
+            while(p<s.size()&&s[p]!=']'){
+                arr->push_back(jsonToIron(s,p));skipJsonWs(s,p);
+                if(p<s.size()&&s[p]==',')p++;
+            }
+            if(p<s.size())p++;return IronValue::makeArr(arr);
+        }
+        if(c=='{'){
+            p++;auto obj=makePooled<IronObject>();skipJsonWs(s,p);
+            while(p<s.size()&&s[p]!='}'){
+                size_t kp=p;auto key=jsonToIron(s,kp);p=kp;skipJsonWs(s,p);
+                if(p<s.size()&&s[p]==':')p++;
+                (*obj)[key->toString()]=jsonToIron(s,p);skipJsonWs(s,p);
+                if(p<s.size()&&s[p]==',')p++;
+            }
+            if(p<s.size())p++;return IronValue::makeObj(obj);
+        }
+        if(s.substr(p,4)=="null"){p+=4;return IronValue::makeNull();}
+        if(s.substr(p,4)=="true"){p+=4;return IronValue::makeBool(true);}
+        if(s.substr(p,5)=="false"){p+=5;return IronValue::makeBool(false);}
+        // number
+        size_t start=p;if(s[p]=='-')p++;
+        while(p<s.size()&&(std::isdigit(s[p])||s[p]=='.'||s[p]=='e'||s[p]=='E'||s[p]=='+'||s[p]=='-'))p++;
+        try{return IronValue::makeNum(std::stod(s.substr(start,p-start)));}catch(...){return IronValue::makeNull();}
+    }
+
+    ValuePtr callValue(ValuePtr callee,std::vector<ValuePtr> args){
+        if(auto*f=std::get_if<NativeFunc>(&callee->data))return (*f)(args);
+        if(auto*f=std::get_if<IronFunc>(&callee->data))return invoke(*f,std::move(args));
+        throw std::runtime_error("That's not a function — can't call it.");
+    }
+
+    void assignLvalue(const Expr& target,ValuePtr val,Env& env){
+        std::visit([&](auto& node){
+            using T=std::decay_t<decltype(node)>;
+            if constexpr(std::is_same_v<T,VarExpr>) env.assign(node.name,val);
+            else if constexpr(std::is_same_v<T,IndexExpr>){
+                auto obj=evalExpr(*node.obj,env);auto idx=evalExpr(*node.index,env);
+                if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&obj->data))if(auto*n=std::get_if<double>(&idx->data)){
+                    int i=(int)*n;
+                    if(i>=0&&i<(int)(*ap)->size()){beforeListWrite(**ap);(**ap)[i]=val;}
                 }
+                if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&obj->data))(**op)[idx->toString()]=val;
             }
+            else if constexpr(std::is_same_v<T,MemberExpr>){
+                auto obj=evalExpr(*node.obj,env);
+                if(auto*op=std::get_if<std::shared_ptr<IronObject>>(&obj->data))(**op)[node.field]=val;
+            }
+        },target.node);
+    }
+
+    // ---- Execute statement ----
+    Flow execStmt(const Stmt& stmt,Env& env){
+        Flow flow=Flow::NORMAL;
+        currentLine=stmt.line;
+        std::visit([&](auto& node){
+            using T=std::decay_t<decltype(node)>;
+
+            if constexpr(std::is_same_v<T,LetStmt>) env.define(node.name,evalExpr(*node.init,env));
+            else if constexpr(std::is_same_v<T,SetStmt>){auto val=evalExpr(*node.value,env);assignLvalue(*node.target,val,env);}
+            else if constexpr(std::is_same_v<T,AddToStmt>){
+                auto val=evalExpr(*node.value,env);
+                auto av=evalExpr(*node.target,env);
+                if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&av->data)){beforeListWrite(**ap);(*ap)->push_back(val);}
+                else throw std::runtime_error("Can't add to that — it's not a list.");
+            }
+            else if constexpr(std::is_same_v<T,SayStmt>) *out<<evalExpr(*node.expr,env)->toString()<<"\n";
+            else if constexpr(std::is_same_v<T,AskStmt>){
+                std::string prompt=evalExpr(*node.prompt,env)->toString();
+                if(!prompt.empty())*out<<prompt<<" "<<std::flush;
+                std::string input;blocking([&]{std::getline(std::cin,input);});
+                try{env.assign(node.varName,IronValue::makeStr(input));}catch(...){env.define(node.varName,IronValue::makeStr(input));}
+            }
+            else if constexpr(std::is_same_v<T,PauseStmt>){
+                *out<<"[Press Enter to continue...]"<<std::flush;
+                blocking([&]{std::cin.ignore(std::numeric_limits<std::streamsize>::max(),'\n');});
+            }
+            else if constexpr(std::is_same_v<T,IfStmt>){
+                Env ie;ie.parent=&env;
+                if(evalExpr(*node.cond,env)->isTruthy())flow=execBlock(node.thenBody,ie);
+                else flow=execBlock(node.elseBody,ie);
+            }
+            else if constexpr(std::is_same_v<T,WhileStmt>) flow=execWhile(node,env);
+            else if constexpr(std::is_same_v<T,ForRangeStmt>) flow=execForRange(node,env);
+            else if constexpr(std::is_same_v<T,ServeStmt>) execServe(node,env);
             else if constexpr(std::is_same_v<T,ForStmt>){
+                // v3.2: for each line in run ... → lines as the command prints them
+                if(auto*re=std::get_if<RunExpr>(&node.iterable->node)){flow=forEachRunLine(node,*re,env);return;}
+                if(auto*ce=std::get_if<CsvExpr>(&node.iterable->node);ce&&ce->file){flow=forEachCsvRow(node,*ce,env);return;}
+                // v3.2: walk the list (or string) where it is, sharing one scope across iterations
                 auto iter=evalExpr(*node.iterable,env);
-                std::vector<ValuePtr> items;
-                if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&iter->data))items=**ap;
-                else if(auto*sp=std::get_if<std::string>(&iter->data))for(char c:*sp)items.push_back(IronValue::makeStr(std::string(1,c)));
-                for(auto&item:items){
-                    Env le;le.parent=&env;le.define(node.var,item);
-                    try{execBlock(node.body,le);}catch(BreakSignal&){break;}catch(ContinueSignal&){continue;}
+                Env le;le.parent=&env;
+                ValuePtr& item=le.vars[node.var];
+                auto step=[&](ValuePtr v){
+                    freshIteration(le,&node.var);item=std::move(v);
+                    return execBlock(node.body,le);
+                };
+                if(auto*ap=std::get_if<std::shared_ptr<IronArray>>(&iter->data)){
+                    std::shared_ptr<IronArray> arr=*ap;
+                    ListWalk walk{arr.get(),nullptr};
+                    listWalks.push_back(&walk);
+                    struct Done{std::vector<ListWalk*>& w;~Done(){w.pop_back();}} done{listWalks};
+                    for(size_t k=0,n=arr->size();k<n;k++){
+                        Flow f=step((walk.before?*walk.before:*arr)[k]);
+                        if(f==Flow::BREAK)break;
+                        if(leavesFunction(f)){flow=f;return;}
+                    }
+                }
+                else if(auto*sp=std::get_if<std::string>(&iter->data)){
+                    for(char c:*sp){
+                        Flow f=step(IronValue::makeStr(std::string(1,c)));
+                        if(f==Flow::BREAK)break;
+                        if(leavesFunction(f)){flow=f;return;}
+                    }
                 }
             }
-            else if constexpr(std::is_same_v<T,BreakStmt>)    throw BreakSignal{};
-            else if constexpr(std::is_same_v<T,ContinueStmt>) throw ContinueSignal{};
-            else if constexpr(std::is_same_v<T,ReturnStmt>)   throw ReturnSignal{evalExpr(*node.value,env)};
+            else if constexpr(std::is_same_v<T,BreakStmt>)    flow=Flow::BREAK;
+            else if constexpr(std::is_same_v<T,ContinueStmt>) flow=Flow::CONTINUE;
+            else if constexpr(std::is_same_v<T,ReturnStmt>){
+                if(node.tail){
+                    // v3.2: hand the call back to invoke() instead of nesting another C++ frame
+                    auto& call=std::get<CallExpr>(node.value->node);
+                    tailCallee=evalExpr(*call.callee,env);
+                    tailArgs.clear();for(auto&a:call.args)tailArgs.push_back(evalExpr(*a,env));
+                    flow=Flow::TAIL_CALL;
+                }else{retVal=evalExpr(*node.value,env);flow=Flow::RETURN;}
+            }
             else if constexpr(std::is_same_v<T,FuncStmt>){
                 IronFunc f{node.params,&node.body,&env};
-                env.define(node.name,IronValue::makeFunc(f));
+                auto fn=IronValue::makeFunc(f);
+                env.capture(fn);
+                env.define(node.name,fn);
             }
             else if constexpr(std::is_same_v<T,CallStmt>) evalExpr(*node.call,env);
             else if constexpr(std::is_same_v<T,GetStmt>){env.define(node.alias,loadModule(node.path));}
@@ -1566,6 +4258,7 @@ class Interpreter {
             // ---- v2.0: class definition ----
             else if constexpr(std::is_same_v<T,ClassStmt>){
                 ClassDef cd;
+                env.pin();  // the class's methods keep this scope for good
                 cd.name=node.name;
                 cd.definitionEnv=&env;
                 for(auto&s:node.body){
@@ -1583,18 +4276,15 @@ class Interpreter {
             else if constexpr(std::is_same_v<T,TryStmt>){
                 Env tryEnv;tryEnv.parent=&env;
                 try{
-                    execBlock(node.body,tryEnv);
-                } catch(ReturnSignal&){throw;   // always propagate control flow
-                } catch(BreakSignal&){throw;
-                } catch(ContinueSignal&){throw;
+                    flow=execBlock(node.body,tryEnv);
                 } catch(ThrowSignal& ts){
                     Env ce;ce.parent=&env;
                     ce.define(node.catchVar,IronValue::makeStr(ts.message));
-                    execBlock(node.catchBody,ce);
+                    flow=execBlock(node.catchBody,ce);
                 } catch(std::exception& e){
                     Env ce;ce.parent=&env;
                     ce.define(node.catchVar,IronValue::makeStr(e.what()));
-                    execBlock(node.catchBody,ce);
+                    flow=execBlock(node.catchBody,ce);
                 }
             }
 
@@ -1622,33 +4312,168 @@ class Interpreter {
             }
 
         },stmt.node);
+        return flow;
+    }
+
+    Flow execBlock(const StmtList& stmts,Env& env){
+        for(auto&s:stmts){Flow f=execStmt(*s,env);if(f!=Flow::NORMAL)return f;}
+        return Flow::NORMAL;
+    }
+    static bool leavesFunction(Flow f){return f==Flow::RETURN||f==Flow::TAIL_CALL;}
+
+    // ---- v3.2: loops ----
+    // Loops reuse one scope; each iteration starts with only `keep` (the loop variable) in it.
+    // The top of each iteration is also a safe point: step budget, timeout, cycle collector.
+    void freshIteration(Env& le,const std::string* keep=nullptr){
+        safePoint();
+        if(le.vars.size()<=(keep?1u:0u))return;
+        for(auto it=le.vars.begin();it!=le.vars.end();)
+            if(keep&&it->first==*keep)++it;else it=le.vars.erase(it);
+    }
+    // Store a number in a variable's slot — in place when nothing else holds the old value.
+    static void setNumber(ValuePtr& slot,double d){
+        if(slot&&slot.use_count()==1)if(auto*n=std::get_if<double>(&slot->data)){*n=d;return;}
+        slot=IronValue::makeNum(d);
+    }
+    // while i < n ... set i = i + c end  (any of < <= > >=, + or - a number literal, last in the body)
+    static bool counterLoop(const WhileStmt& w,const BinExpr*& cmp,double& inc){
+        auto*b=std::get_if<BinExpr>(&w.cond->node);
+        if(!b||!(b->op=="<"||b->op=="<="||b->op==">"||b->op==">=")||w.body.empty())return false;
+        auto*v=std::get_if<VarExpr>(&b->left->node);
+        auto*set=std::get_if<SetStmt>(&w.body.back()->node);
+        if(!v||!set)return false;
+        auto*t=std::get_if<VarExpr>(&set->target->node);
+        auto*add=std::get_if<BinExpr>(&set->value->node);
+        if(!t||t->name!=v->name||!add||(add->op!="+"&&add->op!="-"))return false;
+        auto*l=std::get_if<VarExpr>(&add->left->node);
+        auto*c=std::get_if<NumberLit>(&add->right->node);
+        if(!l||l->name!=v->name||!c)return false;
+        cmp=b;inc=add->op=="+"?c->value:-c->value;
+        return true;
+    }
+    static bool compareNum(const std::string& op,double a,double b){
+        return op=="<"?a<b:op=="<="?a<=b:op==">"?a>b:a>=b;
     }
 
-    void execBlock(const StmtList& stmts,Env& env){for(auto&s:stmts)execStmt(*s,env);}
+    Flow execWhile(const WhileStmt& node,Env& env){
+        Env le;le.parent=&env;
+        const BinExpr* cmp;double inc;
+        ValuePtr* slot=nullptr;  // the counter's variable, found once instead of hashed every time round
+        if(counterLoop(node,cmp,inc)){
+            auto& name=std::get<VarExpr>(cmp->left->node).name;
+            for(Env* e=&env;e&&!slot;e=e->parent){auto it=e->vars.find(name);if(it!=e->vars.end())slot=&it->second;}
+        }
+        if(!slot){
+            while(evalExpr(*node.cond,env)->isTruthy()){
+                freshIteration(le);
+                Flow f=execBlock(node.body,le);
+                if(f==Flow::BREAK)break;
+                if(leavesFunction(f))return f;
+            }
+            return Flow::NORMAL;
+        }
+        const std::string& name=std::get<VarExpr>(cmp->left->node).name;
+        const Stmt& bump=*node.body.back();
+        for(;;){
+            bool go;
+            auto limit=evalExpr(*cmp->right,env);
+            auto*iv=std::get_if<double>(&(*slot)->data);auto*lv=std::get_if<double>(&limit->data);
+            if(iv&&lv)go=compareNum(cmp->op,*iv,*lv);
+            else go=binaryOp(cmp->op,*slot,limit)->isTruthy();
+            if(!go)break;
+            freshIteration(le);
+            Flow f=Flow::NORMAL;
+            for(size_t k=0;k+1<node.body.size()&&f==Flow::NORMAL;k++)f=execStmt(*node.body[k],le);
+            if(f==Flow::BREAK)break;
+            if(leavesFunction(f))return f;
+            if(f==Flow::CONTINUE)continue;  // skips the bump, as it always has
+            // shadowed by a 'let' in the body, or no longer a number: run the statement as written
+            iv=std::get_if<double>(&(*slot)->data);
+            if(iv&&!le.vars.count(name))setNumber(*slot,*iv+inc);
+            else execStmt(bump,le);
+        }
+        return Flow::NORMAL;
+    }
+
+    Flow execForRange(const ForRangeStmt& node,Env& env){
+        auto number=[&](const ExprPtr& e,const char* what){
+            auto v=evalExpr(*e,env);
+            auto*d=std::get_if<double>(&v->data);
+            if(!d)throw std::runtime_error(std::string("'for ")+node.var+" from ...' needs numbers — the "+what+" is "+v->toString()+".");
+            // NaN never compares past the end, and an infinite start or step never gets anywhere
+            if(!std::isfinite(*d))throw std::runtime_error(std::string("'for ")+node.var+" from ...' needs finite numbers — the "+what+" is "+v->toString()+".");
+            return *d;
+        };
+        double from=number(node.from,"start"),to=number(node.to,"end"),step=node.step?number(node.step,"step"):1;
+        if(step==0)throw std::runtime_error("'for "+node.var+" from ... by 0' would never finish.");
+        Env le;le.parent=&env;
+        ValuePtr& slot=le.vars[node.var];
+        for(double k=0;;k++){
+            double i=from+k*step;  // not i+=step: fractional steps don't drift
+            if(step>0?i>to:i<to)break;
+            freshIteration(le,&node.var);
+            setNumber(slot,i);
+            Flow f=execBlock(node.body,le);
+            if(f==Flow::BREAK)break;
+            if(leavesFunction(f))return f;
+        }
+        return Flow::NORMAL;
+    }
+
+    // v3.2: stream a command's stdout line by line into a for-each body.
+    // stderr goes to the terminal (merged for shell strings); 'break' stops the command.
+    Flow forEachRunLine(const ForStmt& node,const RunExpr& re,Env& env){
+        bool shell;
+        auto argv=commandArgv(evalExpr(*re.cmd,env),shell);
+        Subprocess proc(argv,shell,shell?Subprocess::MERGE:Subprocess::INHERIT,runInput(re,env));
+        std::string buf;size_t start=0;bool more=true;
+        while(more){
+            more=blocking([&]{return proc.read(buf,deadline);});
+            size_t nl;
+            while((nl=buf.find('\n',start))!=std::string::npos||(!more&&start<buf.size())){
+                size_t end=nl==std::string::npos?buf.size():nl;
+                std::string line=buf.substr(start,end-start);
+                if(!line.empty()&&line.back()=='\r')line.pop_back();
+                start=nl==std::string::npos?buf.size():nl+1;
+                Env le;le.parent=&env;le.define(node.var,IronValue::makeStr(std::move(line)));
+                Flow f=execBlock(node.body,le);
+                if(f==Flow::BREAK||leavesFunction(f)){proc.kill();proc.wait();return f==Flow::BREAK?Flow::NORMAL:f;}
+            }
+            buf.erase(0,start);start=0;
+        }
+        blocking([&]{proc.wait(deadline);});
+        return Flow::NORMAL;
+    }
 
     // ---- Standard Library + User Modules ----
     ValuePtr loadModule(const std::string& name){
         // v3.0: load a .irw file as a module
         if(name.size()>4 && name.substr(name.size()-4)==".irw"){
-            std::ifstream f(name);
-            if(!f)throw std::runtime_error("Can't open module: "+name);
-            std::string src((std::istreambuf_iterator<char>(f)),{});
-            Lexer lex(src);auto toks=lex.tokenize();
-            Parser par(std::move(toks));
-            moduleAsts.push_back(par.parse()); // persist AST — IronFunc.body ptrs depend on it
-            StmtList& prog=moduleAsts.back();
+            std::error_code ec;
+            auto key=std::filesystem::weakly_canonical(name,ec).string();
+            if(ec)key=name;
+            auto mtime=std::filesystem::last_write_time(name,ec);
+            auto cached=moduleCache.find(key);
+            if(cached!=moduleCache.end()&&!ec&&cached->second.mtime==mtime)return cached->second.exports;
+            moduleAsts.push_back(parseModule(key,name,mtime,!ec).program); // persist AST — IronFunc.body ptrs depend on it
+            const StmtList& prog=*moduleAsts.back();
             moduleEnvs.emplace_back();
             Env& modEnv=moduleEnvs.back();
             modEnv.parent=&globalEnv;
-            execBlock(prog,modEnv);
-            auto obj=std::make_shared<IronObject>();
+            // cache before running, so a circular 'get' gets this object instead of recursing. It is empty
+            // until the module body has finished; its names are copied in only then, after execBlock
+            auto obj=makePooled<IronObject>();
+            auto exports=IronValue::makeObj(obj);
+            moduleCache[key]={mtime,exports};
+            try{execBlock(prog,modEnv);}catch(...){moduleCache.erase(key);throw;}
             for(auto&[k,v]:modEnv.vars)(*obj)[k]=v;
-            return IronValue::makeObj(obj);
+            return exports;
         }
-        auto obj=std::make_shared<IronObject>();
+        if((name=="stdlib"||name=="std")&&stdlibModule)return stdlibModule;
+        auto obj=makePooled<IronObject>();
         if(name=="stdlib"||name=="std"){
             // math
-            auto math=std::make_shared<IronObject>();
+            auto math=makePooled<IronObject>();
             (*math)["abs"]   =IronValue::makeNative([](std::vector<ValuePtr>a){return IronValue::makeNum(std::abs(std::get<double>(a[0]->data)));});
             (*math)["floor"] =IronValue::makeNative([](std::vector<ValuePtr>a){return IronValue::makeNum(std::floor(std::get<double>(a[0]->data)));});
             (*math)["ceil"]  =IronValue::makeNative([](std::vector<ValuePtr>a){return IronValue::makeNum(std::ceil(std::get<double>(a[0]->data)));});
@@ -1657,12 +4482,13 @@ class Interpreter {
             (*math)["pow"]   =IronValue::makeNative([](std::vector<ValuePtr>a){return IronValue::makeNum(std::pow(std::get<double>(a[0]->data),std::get<double>(a[1]->data)));});
             (*obj)["math"]=IronValue::makeObj(math);
             // io
-            auto io=std::make_shared<IronObject>();
+            auto io=makePooled<IronObject>();
             (*io)["alert"]  =IronValue::makeNative([](std::vector<ValuePtr>a){std::cout<<"[ALERT] "<<(a.empty()?"":a[0]->toString())<<"\n";return IronValue::makeNull();});
             (*io)["prompt"] =IronValue::makeNative([](std::vector<ValuePtr>a){if(!a.empty())std::cout<<a[0]->toString()<<" ";std::string s;std::getline(std::cin,s);return IronValue::makeStr(s);});
             (*io)["confirm"]=IronValue::makeNative([](std::vector<ValuePtr>a){if(!a.empty())std::cout<<a[0]->toString()<<" (y/n) ";std::string s;std::getline(std::cin,s);return IronValue::makeBool(s=="y"||s=="Y"||s=="yes");});
             (*obj)["io"]=IronValue::makeObj(io);
             (*obj)["add"]=IronValue::makeNative([](std::vector<ValuePtr>a){return IronValue::makeNum(std::get<double>(a[0]->data)+std::get<double>(a[1]->data));});
+            return stdlibModule=IronValue::makeObj(obj);
         }
         return IronValue::makeObj(obj);
     }
@@ -1673,11 +4499,11 @@ class Interpreter {
         globalEnv.define("toString",  IronValue::makeNative([](std::vector<ValuePtr>a)->ValuePtr{if(a.empty())return IronValue::makeStr("");return IronValue::makeStr(a[0]->toString());}));
         globalEnv.define("len",       IronValue::makeNative([](std::vector<ValuePtr>a)->ValuePtr{if(a.empty())return IronValue::makeNum(0);if(auto*s=std::get_if<std::string>(&a[0]->data))return IronValue::makeNum(s->size());if(auto*ar=std::get_if<std::shared_ptr<IronArray>>(&a[0]->data))return IronValue::makeNum((*ar)->size());return IronValue::makeNum(0);}));
         // v3.0: args list from command line
-        auto argsArr=std::make_shared<IronArray>();
+        auto argsArr=makePooled<IronArray>();
         for(auto&a:userArgs)argsArr->push_back(IronValue::makeStr(a));
         globalEnv.define("args",IronValue::makeArr(argsArr));
         // math globally
-        auto math=std::make_shared<IronObject>();
+        auto math=makePooled<IronObject>();
         (*math)["abs"]   =IronValue::makeNative([](std::vector<ValuePtr>a){return IronValue::makeNum(std::abs(std::get<double>(a[0]->data)));});
         (*math)["floor"] =IronValue::makeNative([](std::vector<ValuePtr>a){return IronValue::makeNum(std::floor(std::get<double>(a[0]->data)));});
         (*math)["ceil"]  =IronValue::makeNative([](std::vector<ValuePtr>a){return IronValue::makeNum(std::ceil(std::get<double>(a[0]->data)));});
@@ -1687,34 +4513,947 @@ class Interpreter {
         globalEnv.define("math",IronValue::makeObj(math));
     }
 public:
-    Interpreter(const std::vector<std::string>& userArgs={}){registerGlobals(userArgs);}
-    void run(const StmtList& program){execBlock(program,globalEnv);}
+    Interpreter(const Limits& lim,const std::vector<std::string>& userArgs):limits(lim){
+        valuePool.limit=limits.maxHeap;if(limits.maxHeap)gcAtBytes=limits.maxHeap/2;
+        frames.reserve(limits.maxDepth);registerGlobals(userArgs);
+        for(auto&[k,v]:globalEnv.vars)builtins.emplace_back(k,v);
+        globalEnv.vars.clear();restoreBuiltins();
+        usePool.leave();  // run() and friends make the pool current on whichever thread calls them
+    }
+    explicit Interpreter(const std::vector<std::string>& userArgs={}):Interpreter(Limits(),userArgs){}
+    ~Interpreter(){usePool.enter();}  // the members' values go back to the pool they came from
+    // nativeStack: bytes of native stack this thread has (0 if unknown).
+    // Returns what a top-level 'return' gave back (null if there was none).
+    ValuePtr run(const StmtList& program,size_t nativeStack=0){
+        Active active{*this};
+        char here;
+        const size_t margin=256*1024;  // room for whatever runs below the last call check
+        if(nativeStack>2*margin){stackBase=(uintptr_t)&here;stackBudget=nativeStack-margin;}
+        else stackBase=0;
+        deadline.set=limits.timeout>0;
+        if(deadline.set)deadline.at=std::chrono::steady_clock::now()+std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(limits.timeout));
+        if(limits.maxSteps||limits.timeout>0)nextCheck=0;
+        return execBlock(program,globalEnv)==Flow::RETURN?std::move(retVal):nullptr;
+    }
+    // ---- v3.2: embedding ----
+    void setOutput(std::ostream& o){out=&o;}
+    void defineGlobal(const std::string& name,ValuePtr v){Active active{*this};globalEnv.define(name,std::move(v));}
+    // a global that survives reset(), like the builtins
+    void defineBuiltin(const std::string& name,ValuePtr v){
+        Active active{*this};
+        auto at=std::find_if(builtins.begin(),builtins.end(),[&](auto& b){return b.first==name;});
+        if(at==builtins.end())builtins.emplace_back(name,v);else at->second=v;
+        globalEnv.define(name,std::move(v));
+    }
+    // Forget what the last script left behind — its globals, classes and modules — so the next
+    // one starts clean. Builtins, the frame pool, the value pool's slabs and open connections stay.
+    void reset(){
+        Active active{*this};
+        retVal=tailCallee=nullptr;tailArgs.clear();
+        globalEnv.vars.clear();
+        classRegistry.clear();moduleCache.clear();stdlibModule=nullptr;
+        reactor.reset();  // fetches the script started and never awaited
+        moduleEnvs.clear();
+        collectCycles();  // what's left is garbage that only its own cycles kept alive
+        moduleAsts.clear();
+        restoreBuiltins();
+        steps=0;nextCheck=UINT64_MAX;currentLine=0;
+    }
+private:
+    // the builtin lists and dicts (args, math) are handed out as copies, so a script that
+    // changes them can't change them for the next one
+    void restoreBuiltins(){
+        for(auto&[name,v]:builtins){
+            if(auto*a=std::get_if<std::shared_ptr<IronArray>>(&v->data))globalEnv.define(name,IronValue::makeArr(makePooled<IronArray>(**a)));
+            else if(auto*o=std::get_if<std::shared_ptr<IronObject>>(&v->data))globalEnv.define(name,IronValue::makeObj(makePooled<IronObject>(**o)));
+            else globalEnv.define(name,v);
+        }
+    }
+public:
+    // v3.2: allocation counters of this interpreter's value pool
+    const ValuePool::Stats& poolStats() const {return valuePool.counters();}
+    // v3.2: --gc-stats
+    void reportGc(std::ostream& out) const {
+        size_t live=valuePool.tracked.size();
+        char line[160];
+        out<<"\n--- GC ---\n";
+        std::snprintf(line,sizeof line,"collections: %zu   pauses: %.2f ms total, %.2f ms longest\n",gc.collections,gc.totalMs,gc.maxMs);out<<line;
+        std::snprintf(line,sizeof line,"freed: %zu lists/dicts/functions in cycles, %zu closure frames\n",gc.freedValues,gc.freedFrames);out<<line;
+        std::snprintf(line,sizeof line,"heap: %zu lists/dicts/functions alive (peak %zu)\n",live,std::max(gc.peak,live));out<<line;
+        auto& p=valuePool.counters();
+        std::snprintf(line,sizeof line,"pool: %zu allocations, %zu frees, %zu too big for a size class\n",p.allocs,p.frees,p.large);out<<line;
+        std::snprintf(line,sizeof line,"pool: %zu KB in use (peak %zu KB), %zu KB in slabs\n",p.bytes/1024,p.peakBytes/1024,p.slabBytes/1024);out<<line;
+    }
+};
+
+// ============================================================
+//  EMBEDDING API  (v3.2)
+//  The ironwood.h classes. An Engine owns one Interpreter and
+//  runs script after script on it: reset() between runs drops
+//  the script's globals, classes and modules but keeps the
+//  builtins, host functions, call frames and the value pool's
+//  slabs. Values cross as plain ironwood::Value copies, so
+//  nothing the host holds points into an engine's pool.
+// ============================================================
+
+class ironwood::Program { public: StmtList stmts; };
+
+static ValuePtr toIron(const ironwood::Value& v){
+    if(auto*b=v.as<bool>())return IronValue::makeBool(*b);
+    if(auto*d=v.as<double>())return IronValue::makeNum(*d);
+    if(auto*s=v.as<std::string>())return IronValue::makeStr(*s);
+    if(auto*l=v.as<ironwood::Value::List>()){
+        auto arr=makePooled<IronArray>();arr->reserve(l->size());
+        for(auto&x:*l)arr->push_back(toIron(x));
+        return IronValue::makeArr(arr);
+    }
+    if(auto*d=v.as<ironwood::Value::Dict>()){
+        auto obj=makePooled<IronObject>();
+        for(auto&[k,x]:*d)(*obj)[k]=toIron(x);
+        return IronValue::makeObj(obj);
+    }
+    return IronValue::makeNull();
+}
+// functions come back as null, and so does a list or dict met again inside itself
+static ironwood::Value fromIron(const ValuePtr& v,std::vector<const IronValue*>& path){
+    if(!v)return {};
+    if(auto*b=std::get_if<bool>(&v->data))return *b;
+    if(auto*d=std::get_if<double>(&v->data))return *d;
+    if(auto*s=std::get_if<std::string>(&v->data))return *s;
+    bool list=std::holds_alternative<std::shared_ptr<IronArray>>(v->data);
+    if(!list&&!std::holds_alternative<std::shared_ptr<IronObject>>(v->data))return {};
+    if(std::find(path.begin(),path.end(),v.get())!=path.end())return {};
+    path.push_back(v.get());
+    ironwood::Value out;
+    if(list){
+        ironwood::Value::List l;
+        for(auto&x:*std::get<std::shared_ptr<IronArray>>(v->data))l.push_back(fromIron(x,path));
+        out=std::move(l);
+    }else{
+        ironwood::Value::Dict d;
+        for(auto&[k,x]:*std::get<std::shared_ptr<IronObject>>(v->data))d.emplace_back(k,fromIron(x,path));
+        std::sort(d.begin(),d.end(),[](auto& a,auto& b){return a.first<b.first;});
+        out=std::move(d);
+    }
+    path.pop_back();
+    return out;
+}
+
+// the stack a thread gets by default (what to guard against when a bigger one can't be had)
+static size_t ownStackSize(){
+#ifdef _WIN32
+    return 1u<<20;
+#else
+    struct rlimit rl;
+    return getrlimit(RLIMIT_STACK,&rl)==0&&rl.rlim_cur!=RLIM_INFINITY?(size_t)rl.rlim_cur:(8u<<20);
+#endif
+}
+
+// The thread an engine runs its scripts on: like runOnBigStack's, but started once and kept,
+// since starting a thread with a stack that size costs more than most scripts take to run.
+class ScriptThread {
+public:
+    explicit ScriptThread(size_t bytes):bytes(bytes){}
+    ~ScriptThread(){
+        if(!started)return;
+        {std::lock_guard<std::mutex> lock(m);quit=true;}
+        wake.notify_one();
+#ifdef _WIN32
+        WaitForSingleObject(thread,INFINITE);CloseHandle(thread);
+#else
+        pthread_join(thread,nullptr);
+#endif
+    }
+    void run(const std::function<void(size_t)>& body){
+        if(!started&&!start()){body(ownStackSize());return;}  // no thread — run here
+        std::unique_lock<std::mutex> lock(m);
+        job=&body;error=nullptr;
+        wake.notify_one();
+        done.wait(lock,[&]{return !job;});
+        if(error)std::rethrow_exception(error);
+    }
+private:
+    size_t bytes;
+    bool started{false},quit{false};
+    const std::function<void(size_t)>* job{nullptr};
+    std::exception_ptr error;
+    std::mutex m;
+    std::condition_variable wake,done;
+#ifdef _WIN32
+    HANDLE thread{nullptr};
+#else
+    pthread_t thread;
+#endif
+    bool start(){
+#ifdef _WIN32
+        thread=CreateThread(nullptr,bytes,[](LPVOID p)->DWORD{((ScriptThread*)p)->loop();return 0;},
+                            this,STACK_SIZE_PARAM_IS_A_RESERVATION,nullptr);
+        started=thread!=nullptr;
+#else
+        pthread_attr_t attr;pthread_attr_init(&attr);
+        started=pthread_attr_setstacksize(&attr,bytes)==0&&
+                pthread_create(&thread,&attr,[](void* p)->void*{((ScriptThread*)p)->loop();return nullptr;},this)==0;
+        pthread_attr_destroy(&attr);
+#endif
+        return started;
+    }
+    void loop(){
+        std::unique_lock<std::mutex> lock(m);
+        for(;;){
+            wake.wait(lock,[&]{return job||quit;});
+            if(quit)return;
+            auto* body=job;
+            lock.unlock();
+            try{(*body)(bytes);}catch(...){error=std::current_exception();}
+            lock.lock();
+            job=nullptr;done.notify_one();
+        }
+    }
 };
 
+struct ironwood::Engine::Impl {
+    Interpreter::Limits limits;
+    Interpreter interp;
+    ScriptThread thread;  // stopped before interp goes
+    explicit Impl(const Interpreter::Limits& l):limits(l),interp(l,{}),thread(l.maxDepth*NATIVE_STACK_PER_CALL+(8u<<20)){}
+};
+
+ironwood::Engine::Engine(const Limits& l){
+    Interpreter::Limits limits;
+    limits.maxDepth=std::min(std::max<size_t>(l.maxDepth,1),MAX_CALL_DEPTH_LIMIT);
+    limits.maxHeap=l.maxHeap;limits.maxSteps=l.maxSteps;limits.timeout=l.timeout;
+    impl=std::make_unique<Impl>(limits);
+}
+ironwood::Engine::~Engine()=default;
+
+ironwood::ProgramPtr ironwood::Engine::compile(const std::string& source){
+    // the optimizer's prebuilt constants are shared by every engine, so they stay off any pool
+    PlainHeap plain;
+    auto program=std::make_shared<Program>();
+    try{program->stmts=parseSource(source);}catch(const std::exception&e){throw Error(e.what());}
+    optimizeProgram(program->stmts);
+    prefetchModules(program->stmts);
+    return program;
+}
+
+void ironwood::Engine::define(const std::string& name,NativeFunction fn){
+    Interpreter::Active active{impl->interp};
+    impl->interp.defineBuiltin(name,IronValue::makeNative([fn=std::move(fn)](std::vector<ValuePtr> a){
+        std::vector<Value> args;args.reserve(a.size());
+        std::vector<const IronValue*> path;
+        for(auto&x:a)args.push_back(fromIron(x,path));
+        return toIron(fn(args));
+    }));
+}
+
+void ironwood::Engine::setOutput(std::ostream& out){impl->interp.setOutput(out);}
+
+ironwood::Value ironwood::Engine::execute(const ProgramPtr& program,const std::vector<std::pair<std::string,Value>>& globals){
+    if(!program)throw Error("execute: no program");
+    Value result;
+    try{
+        impl->thread.run([&](size_t stack){
+            Interpreter& in=impl->interp;
+            Interpreter::Active active{in};
+            struct Clean{Interpreter& in;~Clean(){in.reset();}} clean{in};
+            for(auto&[name,v]:globals)in.defineGlobal(name,toIron(v));
+            std::vector<const IronValue*> path;
+            result=fromIron(in.run(program->stmts,stack),path);
+        });
+    }catch(const Error&){throw;}
+    catch(const std::exception&e){throw Error(e.what());}
+    catch(const ThrowSignal&t){throw Error(t.message);}
+    catch(const LimitSignal&l){throw Error(l.message);}
+    return result;
+}
+
+ironwood::EnginePool::EnginePool(size_t size,const Limits& limits){
+    for(size_t i=0;i<std::max<size_t>(size,1);i++){
+        engines.push_back(std::make_unique<Engine>(limits));
+        idle.push_back(engines.back().get());
+    }
+}
+ironwood::EnginePool::Lease ironwood::EnginePool::acquire(){
+    std::unique_lock<std::mutex> lock(m);
+    freed.wait(lock,[&]{return !idle.empty();});
+    Engine* e=idle.back();idle.pop_back();
+    return Lease(this,e);
+}
+void ironwood::EnginePool::release(Engine* e){
+    {std::lock_guard<std::mutex> lock(m);idle.push_back(e);}
+    freed.notify_one();
+}
+void ironwood::EnginePool::define(const std::string& name,const NativeFunction& fn){
+    for(auto&e:engines)e->define(name,fn);
+}
+
+#ifndef IRONWOOD_NO_MAIN  // v3.2: defined when the interpreter is built into a host program (ironwood.h)
+
+// ============================================================
+//  SERVER  (v3.2)
+//  ironwood --serve <socket> [--workers N]: a daemon that runs
+//  scripts for clients over a Unix domain socket, so a request
+//  costs one run instead of a process start and a parse. Each
+//  worker thread owns a warm Engine (see EMBEDDING API); the
+//  compiled scripts and parsed modules are shared by all of them.
+//
+//  One request per line (at most 64 KiB), any number per connection:
+//    <script path> [TAB arg]... LF
+//  answered with what the script said (its 'say' output):
+//    ok <n> LF <n bytes said>
+//    error <n> <m> LF <n bytes said> <m bytes of error message>
+//  Between requests a connection waits in serve()'s poll set, not on
+//  a worker.
+// ============================================================
+
+#ifndef _WIN32
+// compiled scripts by path, recompiled when the file changes
+class ScriptCache {
+public:
+    ironwood::ProgramPtr get(const std::string& path){
+        std::error_code ec;
+        auto mtime=std::filesystem::last_write_time(path,ec);
+        if(ec)throw ironwood::Error("Can't open file: "+path);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            auto it=scripts.find(path);
+            if(it!=scripts.end()&&it->second.mtime==mtime)return it->second.program;
+        }
+        std::ifstream f(path);
+        if(!f)throw ironwood::Error("Can't open file: "+path);
+        auto program=ironwood::Engine::compile(std::string((std::istreambuf_iterator<char>(f)),{}));
+        std::lock_guard<std::mutex> lock(m);
+        scripts[path]={mtime,program};
+        return program;
+    }
+private:
+    struct Entry { std::filesystem::file_time_type mtime; ironwood::ProgramPtr program; };
+    std::mutex m;
+    std::unordered_map<std::string,Entry> scripts;
+};
+
+class ScriptServer {
+public:
+    static constexpr size_t MAX_LINE=64*1024;  // a longer request line closes the connection
+    ScriptServer(size_t workers,const ironwood::Limits& limits){
+        if(openPipe(wake)<0)throw std::runtime_error(std::string("--serve: pipe failed: ")+std::strerror(errno));
+        for(size_t i=0;i<workers;i++)threads.emplace_back([this,limits]{work(limits);});
+    }
+    ~ScriptServer(){
+        {std::lock_guard<std::mutex> lock(m);stopping=true;}
+        ready.notify_all();
+        for(auto&t:threads)t.join();
+        for(auto&c:waiting)close(c.fd);
+        for(auto&c:returned)close(c.fd);
+        for(auto&[fd,buf]:idle)close(fd);
+        for(auto&[fd,n]:draining)close(fd);
+        close(wake[0]);close(wake[1]);
+    }
+    // Waits on the listener and on every connection between requests; a connection goes to a
+    // worker only once a whole request line is in, and comes back here after it's answered,
+    // so an idle client never holds a worker. Returns only if accepting fails.
+    void serve(int listener){
+        std::vector<pollfd> fds;
+        char chunk[4096];
+        for(;;){
+            fds.clear();
+            fds.push_back({listener,POLLIN,0});
+            fds.push_back({wake[0],POLLIN,0});
+            for(auto&[fd,buf]:idle)fds.push_back({fd,POLLIN,0});
+            for(auto&[fd,n]:draining)fds.push_back({fd,POLLIN,0});
+            if(poll(fds.data(),fds.size(),-1)<0){
+                if(errno==EINTR)continue;
+                std::cerr<<"--serve: poll failed: "<<std::strerror(errno)<<"\n";return;
+            }
+            if(fds[1].revents){
+                if(read(wake[0],chunk,sizeof chunk)<0){}  // any bytes left over just wake us again
+                std::lock_guard<std::mutex> lock(m);
+                for(auto&c:returned)
+                    if(c.refused)refuse(c.fd);
+                    else if(c.buf.find('\n')!=std::string::npos)waiting.push_back(std::move(c));  // pipelined
+                    else idle[c.fd]=std::move(c.buf);
+                returned.clear();
+                if(!waiting.empty())ready.notify_all();
+            }
+            for(size_t i=2;i<fds.size();i++){
+                if(!fds[i].revents)continue;
+                int fd=fds[i].fd;
+                ssize_t n=recv(fd,chunk,sizeof chunk,0);
+                if(n<0&&errno==EINTR)continue;
+                if(auto d=draining.find(fd);d!=draining.end()){
+                    if(n<=0||(d->second+=n)>MAX_DRAIN){close(fd);draining.erase(d);}
+                    continue;
+                }
+                if(n<=0){close(fd);idle.erase(fd);continue;}
+                auto& buf=idle[fd];
+                buf.append(chunk,n);
+                if(buf.find('\n',buf.size()-n)!=std::string::npos){
+                    {std::lock_guard<std::mutex> lock(m);waiting.push_back({fd,std::move(buf)});}
+                    ready.notify_one();
+                    idle.erase(fd);
+                }
+                else if(buf.size()>MAX_LINE){idle.erase(fd);refuse(fd);}
+            }
+            if(fds[0].revents){
+                int fd=acceptSocket(listener);
+                if(fd<0){
+                    if(errno==EINTR||errno==ECONNABORTED||errno==EAGAIN)continue;
+                    std::cerr<<"--serve: accept failed: "<<std::strerror(errno)<<"\n";return;
+                }
+                idle[fd];
+            }
+        }
+    }
+private:
+    struct Conn { int fd; std::string buf; bool refused{false}; };  // buf: received, not yet answered
+    ScriptCache scripts;
+    std::vector<std::thread> threads;
+    std::mutex m;
+    std::condition_variable ready;
+    std::deque<Conn> waiting;   // connections with a request line in, for the workers
+    std::vector<Conn> returned; // answered connections on their way back to serve()
+    bool stopping{false};
+    int wake[2]{-1,-1};         // a worker writes a byte here when it hands a connection back
+    std::unordered_map<int,std::string> idle;  // serve() only: connections between requests
+    // serve() only: refused connections → bytes read since. What the client still sends is read
+    // and dropped until it hangs up (or MAX_DRAIN), so closing doesn't reset away the error.
+    std::unordered_map<int,size_t> draining;
+    static constexpr size_t MAX_DRAIN=1<<20;
+
+    void work(ironwood::Limits limits){
+        ironwood::Engine engine(limits);
+        for(;;){
+            Conn c;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                ready.wait(lock,[&]{return stopping||!waiting.empty();});
+                if(stopping)return;
+                c=std::move(waiting.front());waiting.pop_front();
+            }
+            if(!talk(engine,c)){close(c.fd);continue;}  // the client went away
+            {std::lock_guard<std::mutex> lock(m);returned.push_back(std::move(c));}
+            char one=1;
+            while(write(wake[1],&one,1)<0&&errno==EINTR){}
+        }
+    }
+    // answers the complete lines in c.buf; false when the client can't be written to
+    bool talk(ironwood::Engine& engine,Conn& c){
+        size_t start=0,nl;
+        while((nl=c.buf.find('\n',start))!=std::string::npos){
+            if(nl-start>MAX_LINE){c.refused=true;return true;}
+            if(!sendAll(c.fd,run(engine,c.buf.substr(start,nl-start))))return false;
+            start=nl+1;
+        }
+        c.buf.erase(0,start);
+        return true;
+    }
+    // a request line over MAX_LINE: say so, stop answering, and close once the client is done
+    void refuse(int fd){
+        std::string msg="Request line longer than "+std::to_string(MAX_LINE)+" bytes";
+        sendAll(fd,"error 0 "+std::to_string(msg.size())+"\n"+msg);
+        shutdown(fd,SHUT_WR);
+        draining[fd]=0;
+    }
+    std::string run(ironwood::Engine& engine,std::string line){
+        if(!line.empty()&&line.back()=='\r')line.pop_back();
+        ironwood::Value::List args;
+        size_t tab=line.find('\t');
+        std::string path=line.substr(0,tab);
+        while(tab!=std::string::npos){
+            size_t next=line.find('\t',tab+1);
+            args.push_back(line.substr(tab+1,next==std::string::npos?std::string::npos:next-tab-1));
+            tab=next;
+        }
+        std::ostringstream said;
+        engine.setOutput(said);
+        try{
+            engine.execute(scripts.get(path),{{"args",std::move(args)}});
+        }catch(const std::exception&e){
+            std::string out=said.str(),msg=e.what();
+            return "error "+std::to_string(out.size())+" "+std::to_string(msg.size())+"\n"+out+msg;
+        }
+        std::string out=said.str();
+        return "ok "+std::to_string(out.size())+"\n"+out;
+    }
+    static bool sendAll(int fd,const std::string& data){
+        for(size_t sent=0;sent<data.size();){
+            ssize_t n=send(fd,data.data()+sent,data.size()-sent,MSG_NOSIGNAL);
+            if(n<0&&errno==EINTR)continue;
+            if(n<=0)return false;
+            sent+=n;
+        }
+        return true;
+    }
+};
+
+static int serveScripts(const std::string& path,size_t workers){
+    sockaddr_un addr{};addr.sun_family=AF_UNIX;
+    if(path.size()>=sizeof addr.sun_path){std::cerr<<"--serve: socket path is too long\n";return 1;}
+    std::memcpy(addr.sun_path,path.c_str(),path.size()+1);
+    std::error_code ec;
+    if(std::filesystem::is_socket(path,ec))unlink(path.c_str());  // left by an earlier server
+    int fd=openSocket(AF_UNIX,SOCK_STREAM,0);
+    if(fd<0||bind(fd,(sockaddr*)&addr,sizeof addr)<0||listen(fd,SOMAXCONN)<0){
+        std::cerr<<"--serve: can't listen on "<<path<<": "<<std::strerror(errno)<<"\n";return 1;
+    }
+    ironwood::Limits limits;
+    limits.maxDepth=maxCallDepth;limits.maxHeap=maxHeapBytes;limits.maxSteps=maxSteps;limits.timeout=timeoutSeconds;
+    std::cerr<<"Serving scripts on "<<path<<" with "<<workers<<" workers\n";
+    {
+        ScriptServer server(workers,limits);
+        server.serve(fd);
+    }
+    close(fd);unlink(path.c_str());
+    return 1;
+}
+#endif
+
+// ============================================================
+//  CHECK  (v3.2)
+//  ironwood --check <file.irw | dir>...: parse each file and look
+//  for mistakes without running anything — undefined names, 'set'
+//  before 'let', unknown classes, and calls to a known function or
+//  class with the wrong number of arguments. Files are checked in
+//  parallel; problems are printed as  path:line: message
+// ============================================================
+
+// classes (and further imports) of the modules the checked files 'get', parsed once per run
+class CheckedModules {
+public:
+    struct Module { bool ok{false}; std::vector<std::pair<std::string,int>> classes; std::vector<std::string> imports; };
+    // read and parsed outside the lock, like parseModule: other modules load at the same time,
+    // and a second thread wanting one that is loading waits for it
+    const Module& get(const std::string& path){
+        std::unique_lock<std::mutex> lock(m);
+        for(;;){
+            auto it=modules.find(path);
+            if(it!=modules.end())return it->second;
+            if(!loading.count(path))break;
+            loaded.wait(lock);
+        }
+        loading.insert(path);
+        lock.unlock();
+        Module mod=load(path);
+        lock.lock();
+        loading.erase(path);
+        const Module& done=modules.emplace(path,std::move(mod)).first->second;
+        loaded.notify_all();
+        return done;
+    }
+    // parameters of the class's init, or -1 if it has none
+    static int initArity(const ClassStmt& c){
+        for(auto&s:c.body)if(auto*fn=std::get_if<FuncStmt>(&s->node);fn&&fn->name=="init")return (int)fn->params.size();
+        return -1;
+    }
+private:
+    std::mutex m;
+    std::condition_variable loaded;
+    std::unordered_map<std::string,Module> modules;  // node-based: references stay valid
+    std::unordered_set<std::string> loading;         // paths some thread is reading
+
+    // a module that can't be read or parsed comes back with ok false
+    static Module load(const std::string& path){
+        Module mod;
+        try{
+            std::ifstream f(path);
+            if(!f)return mod;
+            std::string src((std::istreambuf_iterator<char>(f)),{});
+            StmtList program=parseSource(src);
+            forEachStmt(program,[&](Stmt& s){if(auto*c=std::get_if<ClassStmt>(&s.node))mod.classes.emplace_back(c->name,initArity(*c));});
+            mod.imports=moduleImports(program);
+            mod.ok=true;
+        }catch(std::exception&){}
+        return mod;
+    }
+};
+
+class ScriptChecker {
+public:
+    struct Problem { int line; std::string message; };
+
+    ScriptChecker(CheckedModules& mods):modules(mods){}
+    std::vector<Problem> check(const std::string& source){
+        StmtList program;
+        try{program=parseSource(source);}
+        catch(std::exception& e){
+            // the parser stops at its first error: "Line N: ..."
+            std::string msg=e.what();int at=0;
+            if(msg.compare(0,5,"Line ")==0){size_t colon=msg.find(": ");at=std::atoi(msg.c_str()+5);if(colon!=std::string::npos)msg.erase(0,colon+2);}
+            for(size_t nl;(nl=msg.find('\n'))!=std::string::npos;)msg.replace(nl,1,"\\n");  // one line per problem
+            return {{at,msg}};
+        }
+        collect(program);
+        Scope top{nullptr,false};
+        for(const char* g:{"parseInt","parseFloat","toString","len","args","math"})top.seen.insert(g);  // registerGlobals
+        block(program,top);
+        std::stable_sort(problems.begin(),problems.end(),[](const Problem& a,const Problem& b){return a.line<b.line;});
+        return std::move(problems);
+    }
+
+private:
+    // What a block defines. 'seen' grows as the block is walked; code in a function body runs
+    // later, so from there an enclosing block's names count wherever they are defined ('all').
+    struct Scope {
+        Scope* parent;
+        bool function;  // a function or method body
+        std::unordered_set<std::string> seen,all;
+        std::unordered_map<std::string,size_t> arity;  // names defined only by one 'function' here
+        Scope(Scope* p,bool fn):parent(p),function(fn){}
+    };
+
+    CheckedModules& modules;
+    std::vector<Problem> problems;
+    int line{0};
+    std::unordered_set<std::string> reassigned;        // 'set name = ...' anywhere: not a known function
+    std::unordered_map<std::string,std::pair<int,int>> classes;  // name → (definitions, init arity: -1 none, -2 defined twice)
+    std::vector<std::string> imports;                  // the file's own 'get "x.irw"'s
+    bool importsRead{false},classesKnown{true};        // classesKnown: false if an imported module couldn't be read
+
+    void problem(std::string msg){problems.push_back({line,std::move(msg)});}
+
+    // the program-wide facts: classes (the registry is global, so imported ones count too), reassigned names
+    void addClass(const std::string& name,int arity){auto& c=classes[name];c.second=c.first++?-2:arity;}
+    void collect(StmtList& program){
+        forEachStmt(program,[&](Stmt& s){
+            if(auto*c=std::get_if<ClassStmt>(&s.node))addClass(c->name,CheckedModules::initArity(*c));
+            else if(auto*set=std::get_if<SetStmt>(&s.node))
+                if(auto*v=std::get_if<VarExpr>(&set->target->node))reassigned.insert(v->name);
+        });
+        imports=moduleImports(program);
+    }
+    // classes from imported modules (and theirs), read the first time a class isn't found here
+    void importClasses(){
+        importsRead=true;
+        std::vector<std::string> todo=std::move(imports);
+        std::unordered_set<std::string> seen(todo.begin(),todo.end());
+        while(!todo.empty()){
+            std::string path=std::move(todo.back());todo.pop_back();
+            auto& mod=modules.get(path);
+            if(!mod.ok){classesKnown=false;continue;}
+            for(auto&[name,arity]:mod.classes)addClass(name,arity);
+            for(auto&p:mod.imports)if(seen.insert(p).second)todo.push_back(p);
+        }
+    }
+
+    // names a block defines directly (not in nested blocks), and which of them are plain functions
+    static void declare(const StmtList& body,Scope& sc){
+        std::unordered_map<std::string,int> defs;
+        auto def=[&](const std::string& n){sc.all.insert(n);defs[n]++;};
+        for(auto&n:sc.seen)def(n);
+        for(auto&s:body){
+            if(auto*l=std::get_if<LetStmt>(&s->node))def(l->name);
+            else if(auto*a=std::get_if<AskStmt>(&s->node))def(a->varName);
+            else if(auto*g=std::get_if<GetStmt>(&s->node))def(g->alias);
+            else if(auto*f=std::get_if<FuncStmt>(&s->node)){def(f->name);sc.arity[f->name]=f->params.size();}
+        }
+        for(auto it=sc.arity.begin();it!=sc.arity.end();)if(defs[it->first]>1)it=sc.arity.erase(it);else ++it;
+    }
+
+    // the scope a name comes from, or null
+    const Scope* lookup(const std::string& name,const Scope& sc) const {
+        bool later=false;
+        for(const Scope* s=&sc;s;s=s->parent){
+            if((later?s->all:s->seen).count(name))return s;
+            if(s->function)later=true;
+        }
+        return nullptr;
+    }
+
+    void block(StmtList& body,Scope& sc){declare(body,sc);for(auto&s:body)stmt(*s,sc);}
+    void child(StmtList& body,Scope& parent,std::initializer_list<std::string> names={}){
+        Scope sc{&parent,false};sc.seen.insert(names);block(body,sc);
+    }
+    void function(StmtList& body,Scope& parent,const std::vector<std::string>& params,bool method=false){
+        Scope sc{&parent,true};
+        sc.seen.insert(params.begin(),params.end());
+        if(method)sc.seen.insert("self");
+        block(body,sc);
+    }
+
+    void stmt(Stmt& s,Scope& sc){
+        line=s.line;
+        std::visit([&](auto& node){
+            using T=std::decay_t<decltype(node)>;
+            if constexpr(std::is_same_v<T,LetStmt>){expr(node.init,sc);sc.seen.insert(node.name);}
+            else if constexpr(std::is_same_v<T,SetStmt>){
+                expr(node.value,sc);
+                if(auto*v=std::get_if<VarExpr>(&node.target->node)){
+                    if(!lookup(v->name,sc))problem("Can't change '"+v->name+"' — use 'let "+v->name+" = ...' to create it first.");
+                }else expr(node.target,sc);
+            }
+            else if constexpr(std::is_same_v<T,AskStmt>){expr(node.prompt,sc);sc.seen.insert(node.varName);}
+            else if constexpr(std::is_same_v<T,IfStmt>){
+                expr(node.cond,sc);
+                child(node.thenBody,sc);
+                child(node.elseBody,sc);
+            }
+            else if constexpr(std::is_same_v<T,WhileStmt>){expr(node.cond,sc);child(node.body,sc);}
+            else if constexpr(std::is_same_v<T,ForStmt>){expr(node.iterable,sc);child(node.body,sc,{node.var});}
+            else if constexpr(std::is_same_v<T,ForRangeStmt>){
+                expr(node.from,sc);expr(node.to,sc);expr(node.step,sc);
+                child(node.body,sc,{node.var});
+            }
+            else if constexpr(std::is_same_v<T,FuncStmt>){sc.seen.insert(node.name);function(node.body,sc,node.params);}
+            else if constexpr(std::is_same_v<T,GetStmt>){
+                if(isModulePath(node.path)&&!std::ifstream(node.path))problem("Can't open module: "+node.path);
+                sc.seen.insert(node.alias);
+            }
+            else if constexpr(std::is_same_v<T,ClassStmt>){
+                // field defaults are worked out at 'new', methods when called: both in this scope
+                Scope later{&sc,true};
+                for(auto&m:node.body){
+                    line=m->line;
+                    if(auto*l=std::get_if<LetStmt>(&m->node))expr(l->init,later);
+                    else if(auto*f=std::get_if<FuncStmt>(&m->node))function(f->body,sc,f->params,true);
+                }
+            }
+            else if constexpr(std::is_same_v<T,TryStmt>){
+                child(node.body,sc);
+                child(node.catchBody,sc,{node.catchVar});
+            }
+            else{
+                // everything else only evaluates expressions
+                ExprVisitor visit{*this,sc};astIO(visit,node);
+            }
+        },s.node);
+    }
+
+    // walks an expression's children through astIO, checking the ones that name things
+    struct ExprVisitor {
+        ScriptChecker& ck;Scope& sc;
+        void operator()(double&){}
+        void operator()(bool&){}
+        void operator()(std::string&){}
+        void operator()(ExprPtr& e){ck.expr(e,sc);}
+        void operator()(StmtList& body){ck.child(body,sc);}
+        template<class T> void operator()(std::vector<T>& v){for(auto&x:v)(*this)(x);}
+        template<class X,class Y> void operator()(std::pair<X,Y>& p){(*this)(p.first);(*this)(p.second);}
+        template<class T,class U,class... R> void operator()(T& a,U& b,R&... rest){(*this)(a);(*this)(b,rest...);}
+    };
+
+    void expr(ExprPtr& e,Scope& sc){
+        if(!e)return;
+        if(auto*v=std::get_if<VarExpr>(&e->node)){
+            if(!lookup(v->name,sc))problem("I don't know what '"+v->name+"' is — did you forget 'let "+v->name+" = ...'?");
+            return;
+        }
+        if(auto*f=std::get_if<FuncExpr>(&e->node)){function(f->body,sc,f->params);return;}
+        if(auto*s=std::get_if<StringLit>(&e->node)){interpolated(s->value,sc);return;}
+        if(auto*c=std::get_if<CallExpr>(&e->node))
+            if(auto*v=std::get_if<VarExpr>(&c->callee->node))
+                if(const Scope* from=lookup(v->name,sc);from&&!reassigned.count(v->name)){
+                    auto it=from->arity.find(v->name);
+                    if(it!=from->arity.end()&&it->second!=c->args.size())
+                        problem("'"+v->name+"' takes "+plural(it->second,"argument")+" but is called with "+std::to_string(c->args.size()));
+                }
+        if(auto*n=std::get_if<ClassNewExpr>(&e->node)){
+            auto it=classes.find(n->className);
+            if(it==classes.end()&&!importsRead){importClasses();it=classes.find(n->className);}
+            if(it==classes.end()){
+                if(classesKnown)problem("Unknown class: "+n->className+" — did you define it with 'class "+n->className+"'?");
+            }else{
+                int arity=it->second.second;
+                if(arity==-1&&!n->args.empty())
+                    problem("'new "+n->className+"' is given "+plural(n->args.size(),"argument")+" but "+n->className+" has no init");
+                else if(arity>=0&&(size_t)arity!=n->args.size())
+                    problem(n->className+"'s init takes "+plural(arity,"argument")+" but 'new "+n->className+"' gives "+std::to_string(n->args.size()));
+            }
+        }
+        ExprVisitor visit{*this,sc};
+        std::visit([&](auto& n){astIO(visit,n);},e->node);
+    }
+
+    // "{expr}" inside a string is evaluated where the string is (see Interpreter::interpolate)
+    void interpolated(const std::string& s,Scope& sc){
+        for(size_t i=s.find('{');i!=std::string::npos;i=s.find('{',i)){
+            size_t j=i+1;int depth=1;
+            while(j<s.size()&&depth>0){if(s[j]=='{')depth++;else if(s[j]=='}')depth--;if(depth>0)j++;}
+            StmtList inner;
+            try{inner=parseSource(s.substr(i+1,j-i-1));}catch(std::exception&){}  // not code: left as text
+            if(!inner.empty())if(auto*es=std::get_if<ExprStmt>(&inner[0]->node))expr(es->expr,sc);
+            i=j+1;
+        }
+    }
+
+    static std::string plural(size_t n,const char* word){return std::to_string(n)+" "+word+(n==1?"":"s");}
+};
+
+// --check: the .irw files named (directories are searched), checked on a thread per core
+static int checkScripts(const std::vector<std::string>& targets){
+    std::vector<std::string> files;
+    for(auto&t:targets){
+        std::error_code ec;
+        if(std::filesystem::is_directory(t,ec)){
+            std::vector<std::string> found;
+            for(auto it=std::filesystem::recursive_directory_iterator(t,ec);!ec&&it!=std::filesystem::recursive_directory_iterator();it.increment(ec))
+                if(it->is_regular_file(ec)&&it->path().extension()==".irw")found.push_back(it->path().string());
+            std::sort(found.begin(),found.end());
+            files.insert(files.end(),found.begin(),found.end());
+        }else files.push_back(t);
+    }
+    std::vector<std::string> reports(files.size());
+    std::vector<size_t> counts(files.size(),0);
+    CheckedModules modules;
+    std::mutex m;size_t next=0;
+    auto work=[&]{
+        for(;;){
+            size_t i;
+            {std::lock_guard<std::mutex> lock(m);if(next==files.size())return;i=next++;}
+            std::ifstream f(files[i]);
+            if(!f){reports[i]=files[i]+": can't open file\n";counts[i]=1;continue;}
+            std::string src((std::istreambuf_iterator<char>(f)),{});
+            ScriptChecker checker(modules);
+            for(auto&p:checker.check(src)){
+                reports[i]+=files[i]+(p.line?":"+std::to_string(p.line):"")+": "+p.message+"\n";
+                counts[i]++;
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    size_t threads=std::min<size_t>(files.size(),std::max(1u,std::thread::hardware_concurrency()));
+    for(size_t i=1;i<threads;i++)pool.emplace_back(work);
+    work();
+    for(auto&t:pool)t.join();
+    size_t total=0,bad=0;
+    for(size_t i=0;i<files.size();i++){std::cout<<reports[i];total+=counts[i];bad+=counts[i]>0;}
+    std::cerr<<files.size()<<(files.size()==1?" file":" files")<<" checked";
+    if(total)std::cerr<<", "<<total<<(total==1?" problem":" problems")<<" in "<<bad;
+    std::cerr<<"\n";
+    return total?1:0;
+}
+
 // ============================================================
 //  MAIN
 // ============================================================
 
+// v3.2: every Ironwood call still nests a few native frames, so the program runs on a
+// thread whose stack fits --max-depth calls. Returns the stack size it ran with.
+static size_t runOnBigStack(size_t bytes,const std::function<void(size_t)>& body){
+    struct Job{
+        const std::function<void(size_t)>& body;size_t bytes;std::exception_ptr error;
+        void run(){try{body(bytes);}catch(...){error=std::current_exception();}}
+    } job{body,bytes,nullptr};
+#ifdef _WIN32
+    HANDLE t=CreateThread(nullptr,bytes,[](LPVOID p)->DWORD{((Job*)p)->run();return 0;},
+                          &job,STACK_SIZE_PARAM_IS_A_RESERVATION,nullptr);
+    if(!t){body(ownStackSize());return ownStackSize();}
+    WaitForSingleObject(t,INFINITE);CloseHandle(t);
+#else
+    pthread_attr_t attr;pthread_attr_init(&attr);
+    pthread_t t;
+    bool ok=pthread_attr_setstacksize(&attr,bytes)==0&&
+            pthread_create(&t,&attr,[](void* p)->void*{((Job*)p)->run();return nullptr;},&job)==0;
+    pthread_attr_destroy(&attr);
+    if(!ok){body(ownStackSize());return ownStackSize();}  // couldn't get that much — run here
+    pthread_join(t,nullptr);
+#endif
+    if(job.error)std::rethrow_exception(job.error);
+    return bytes;
+}
+
+static bool showGcStats=false;  // --gc-stats
 int main(int argc,char** argv){
 #ifdef _WIN32
     WSADATA wsaData;
     WSAStartup(MAKEWORD(2,2),&wsaData);
 #endif
     srand((unsigned)time(nullptr));
-    if(argc<2){std::cerr<<"Usage: ironwood <file.irw> [args...]\n";return 1;}
-    std::ifstream file(argv[1]);
-    if(!file){std::cerr<<"Can't open file: "<<argv[1]<<"\n";return 1;}
+#ifndef _WIN32
+    signal(SIGPIPE,SIG_IGN);  // a closed socket or pipe is an error return, not process death
+#endif
+    // options come before the script name; everything after it belongs to the script
+    int argi=1;
+    std::string servePath;
+    bool check=false;
+    size_t workers=std::max(1u,std::thread::hardware_concurrency());
+    for(;argi<argc&&argv[argi][0]=='-'&&argv[argi][1];argi++){
+        std::string opt=argv[argi];
+        if(opt=="--no-cache")useAstCache=false;
+        else if(opt=="-O0"||opt=="-O1")optLevel=opt[2]-'0';
+        else if(opt=="--gc-stats")showGcStats=true;
+        else if(opt=="--serve"&&argi+1<argc)servePath=argv[++argi];
+        else if(opt=="--check")check=true;
+        else if(opt=="--workers"&&argi+1<argc){
+            workers=std::strtoul(argv[++argi],nullptr,10);
+            if(workers==0||workers>1024){std::cerr<<"--workers needs a number from 1 to 1024\n";return 1;}
+        }
+        else if(opt=="--max-steps"&&argi+1<argc){
+            maxSteps=std::strtoull(argv[++argi],nullptr,10);
+            if(!maxSteps){std::cerr<<"--max-steps needs a positive number\n";return 1;}
+        }
+        else if(opt=="--timeout"&&argi+1<argc){
+            timeoutSeconds=std::strtod(argv[++argi],nullptr);
+            if(!(timeoutSeconds>0)){std::cerr<<"--timeout needs a number of seconds, like 2 or 0.5\n";return 1;}
+        }
+        else if(opt=="--max-heap"&&argi+1<argc){
+            char* unit;double n=std::strtod(argv[++argi],&unit);
+            double scale=*unit=='k'||*unit=='K'?1024.0:*unit=='m'||*unit=='M'?1048576.0:*unit=='g'||*unit=='G'?1073741824.0:1.0;
+            if(n<=0||(scale==1.0&&*unit)){std::cerr<<"--max-heap needs a size, like 512k, 64m or 2g\n";return 1;}
+            maxHeapBytes=(size_t)(n*scale);
+        }
+        else if(opt=="--max-depth"&&argi+1<argc){
+            maxCallDepth=std::strtoul(argv[++argi],nullptr,10);
+            if(maxCallDepth==0||maxCallDepth>MAX_CALL_DEPTH_LIMIT){
+                std::cerr<<"--max-depth needs a number from 1 to "<<MAX_CALL_DEPTH_LIMIT<<"\n";return 1;
+            }
+        }
+        else{std::cerr<<"Unknown option: "<<opt<<"\n";return 1;}
+    }
+    if(!servePath.empty()){
+#ifdef _WIN32
+        std::cerr<<"--serve needs Unix domain sockets (Linux / macOS)\n";return 1;
+#else
+        return serveScripts(servePath,workers);
+#endif
+    }
+    if(check&&argi<argc)return checkScripts(std::vector<std::string>(argv+argi,argv+argc));
+    if(argi>=argc){
+        std::cerr<<"Usage: ironwood [options] <file.irw> [args...]\n"
+                   "       ironwood [options] --serve <socket> [--workers N]\n"
+                   "       ironwood --check <file.irw | dir>...\n"
+                   "  -O0 / -O1       don't / do fold constants before running (default -O1)\n"
+                   "  --no-cache      don't read or write the parsed-program cache (.irwc)\n"
+                   "  --max-depth N   allow N nested function calls (default 10000)\n"
+                   "  --max-heap N    stop the script with an error once it uses N bytes (k/m/g suffix)\n"
+                   "  --max-steps N   stop the script after N loop iterations and calls\n"
+                   "  --timeout S     stop the script after S seconds\n"
+                   "  --gc-stats      print cycle-collector statistics when the script ends\n"
+                   "  --serve PATH    run scripts for clients on a Unix socket (see README)\n"
+                   "  --workers N     scripts --serve runs at once (default: one per core)\n"
+                   "  --check         report mistakes in the files without running them\n";
+        return 1;
+    }
+    ownsProcess=true;
+    std::ifstream file(argv[argi]);
+    if(!file){std::cerr<<"Can't open file: "<<argv[argi]<<"\n";return 1;}
     std::string source((std::istreambuf_iterator<char>(file)),{});
     std::vector<std::string> userArgs;
-    for(int i=2;i<argc;i++)userArgs.push_back(argv[i]);
+    for(int i=argi+1;i<argc;i++)userArgs.push_back(argv[i]);
     try{
-        Lexer lexer(source);auto tokens=lexer.tokenize();
-        Parser parser(std::move(tokens));auto program=parser.parse();
-        Interpreter interp(userArgs);interp.run(program);
+        auto program=loadProgram(argv[argi],source);
+        optimizeProgram(program);
+        prefetchModules(program);
+        runOnBigStack(maxCallDepth*NATIVE_STACK_PER_CALL+(8u<<20),[&](size_t stack){
+            Interpreter interp(userArgs);
+            struct Report{Interpreter& in;~Report(){if(showGcStats)in.reportGc(std::cerr);}} report{interp};
+            interp.run(program,stack);
+        });
     }catch(const std::exception&e){
         std::cerr<<"\n--- Ironwood Error ---\n"<<e.what()<<"\n";
 #ifdef _WIN32
         WSACleanup();
+#endif
+        return 1;
+    }catch(const ThrowSignal&t){  // an uncaught 'throw' (or stack overflow)
+        std::cerr<<"\n--- Ironwood Error ---\n"<<t.message<<"\n";
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return 1;
+    }catch(const LimitSignal&l){  // --max-steps / --timeout
+        std::cerr<<"\n--- Ironwood Error ---\n"<<l.message<<"\n";
+#ifdef _WIN32
+        WSACleanup();
 #endif
         return 1;
     }
@@ -1723,3 +5462,4 @@ int main(int argc,char** argv){
 #endif
     return 0;
 }
+#endif